@@ -0,0 +1,369 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// bundles the application's assets - textures, shader sources, scene
+// data - into one aligned archive file, mapped once at startup and
+// served as zero-copy slices, so loading never pays per-file open and
+// stat overhead or depends on the working directory layout
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// declaration of global variables and defines
+namespace
+{
+	// identifies the archive format - bumped whenever the
+	// layout changes so stale archives are rejected cleanly
+	const uint32_t g_PackMagic = 0x4B415041; // 'APAK'
+	const uint32_t g_PackVersion = 1;
+
+	// every asset's bytes start on this boundary inside the
+	// archive, so slices can be handed to parsers directly
+	const size_t g_AssetAlignment = 64;
+
+	// the longest asset name an entry can hold, including the
+	// terminating zero
+	const int g_MaxAssetNameLength = 64;
+
+#pragma pack(push, 1)
+	// the archive starts with this header, followed by the
+	// entry table, followed by the aligned asset bytes
+	struct PACK_HEADER
+	{
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t assetCount = 0;
+		uint32_t reserved = 0;
+	};
+
+	struct PACK_ENTRY
+	{
+		char name[g_MaxAssetNameLength] = { 0 };
+		uint64_t byteOffset = 0;
+		uint64_t byteSize = 0;
+	};
+#pragma pack(pop)
+
+	// the files the builder bundles - everything the scene
+	// opens at startup
+	const char* const g_PackManifest[] =
+	{
+		"textures/wood.jpg",
+		"textures/wall.jpg",
+		"textures/pot.jpg",
+		"textures/leaf.jpg",
+		"textures/lamp.jpg",
+		"textures/marble.jpg",
+		"textures/granite.jpg",
+		"textures/gold.jpg",
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl",
+		"scene.txt",
+	};
+	const int g_PackManifestCount =
+		(int)(sizeof(g_PackManifest) / sizeof(g_PackManifest[0]));
+
+	/*******************************************************
+	 *  ReadWholeFile()
+	 *
+	 *  This function reads one loose file into the passed
+	 *  in byte vector, returning false when it is missing.
+	 *******************************************************/
+	bool ReadWholeFile(const char* filename, std::vector<unsigned char>& fileBytes)
+	{
+		FILE* pFile = NULL;
+#if defined(_MSC_VER)
+		fopen_s(&pFile, filename, "rb");
+#else
+		pFile = fopen(filename, "rb");
+#endif
+		if (NULL == pFile)
+		{
+			return(false);
+		}
+
+		fseek(pFile, 0, SEEK_END);
+		long fileSize = ftell(pFile);
+		fseek(pFile, 0, SEEK_SET);
+
+		fileBytes.resize((size_t)fileSize);
+		size_t bytesRead = fread(fileBytes.data(), 1, fileBytes.size(), pFile);
+		fclose(pFile);
+
+		return(bytesRead == fileBytes.size());
+	}
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared asset pack used
+ *  by all of the loading code.
+ ***********************************************************/
+AssetPack& AssetPack::Instance()
+{
+	static AssetPack instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+#if defined(_WIN32)
+	if (m_packData != nullptr)
+	{
+		UnmapViewOfFile(m_packData);
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+	}
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+	}
+#endif
+}
+
+/***********************************************************
+ *  Mount()
+ *
+ *  This method maps the archive into memory and builds the
+ *  asset directory - one open, one map, no further file
+ *  system work for any asset it serves.
+ ***********************************************************/
+bool AssetPack::Mount(const char* packFilename)
+{
+#if defined(_WIN32)
+	HANDLE fileHandle = CreateFileA(packFilename, GENERIC_READ, FILE_SHARE_READ,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(fileHandle, &fileSize) == FALSE)
+	{
+		CloseHandle(fileHandle);
+		return(false);
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL)
+	{
+		CloseHandle(fileHandle);
+		return(false);
+	}
+
+	const unsigned char* packData =
+		(const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (packData == nullptr)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return(false);
+	}
+
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+	m_packData = packData;
+	m_packSize = (size_t)fileSize.QuadPart;
+#else
+	// no file mapping here - one read of the whole archive
+	// still beats opening every asset separately
+	if (ReadWholeFile(packFilename, m_packBytes) == false)
+	{
+		return(false);
+	}
+	m_packData = m_packBytes.data();
+	m_packSize = m_packBytes.size();
+#endif
+
+	// validate the header and walk the entry table
+	if (m_packSize < sizeof(PACK_HEADER))
+	{
+		return(false);
+	}
+
+	const PACK_HEADER* header = (const PACK_HEADER*)m_packData;
+	if ((header->magic != g_PackMagic) ||
+		(header->version != g_PackVersion) ||
+		(m_packSize < sizeof(PACK_HEADER) + header->assetCount * sizeof(PACK_ENTRY)))
+	{
+		std::cout << "WARNING: Ignoring malformed asset pack "
+			<< packFilename << std::endl;
+		m_packData = nullptr;
+		return(false);
+	}
+
+	const PACK_ENTRY* entries =
+		(const PACK_ENTRY*)(m_packData + sizeof(PACK_HEADER));
+	for (uint32_t entry = 0; entry < header->assetCount; entry++)
+	{
+		ASSET_ENTRY assetEntry;
+		assetEntry.byteOffset = (size_t)entries[entry].byteOffset;
+		assetEntry.byteSize = (size_t)entries[entry].byteSize;
+		m_assetDirectory[entries[entry].name] = assetEntry;
+	}
+
+	std::cout << "INFO: Mounted asset pack " << packFilename
+		<< " with " << header->assetCount << " assets" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsMounted()
+ *
+ *  This method returns true once an archive has been
+ *  mounted.
+ ***********************************************************/
+bool AssetPack::IsMounted() const
+{
+	return(m_packData != nullptr);
+}
+
+/***********************************************************
+ *  GetAsset()
+ *
+ *  This method looks an asset up by its loose-file path and
+ *  returns a zero-copy slice into the mapped archive.
+ ***********************************************************/
+bool AssetPack::GetAsset(
+	const char* assetName,
+	const unsigned char*& assetData,
+	size_t& assetSize) const
+{
+	if (m_packData == nullptr)
+	{
+		return(false);
+	}
+
+	auto entry = m_assetDirectory.find(assetName);
+	if (entry == m_assetDirectory.end())
+	{
+		return(false);
+	}
+
+	assetData = m_packData + entry->second.byteOffset;
+	assetSize = entry->second.byteSize;
+	return(true);
+}
+
+/***********************************************************
+ *  BuildPack()
+ *
+ *  This method bundles the asset manifest into the archive -
+ *  the offline half of the subsystem, run with the --pack
+ *  command line flag from the project folder.
+ ***********************************************************/
+bool AssetPack::BuildPack(const char* packFilename)
+{
+	std::vector<PACK_ENTRY> entries;
+	std::vector<unsigned char> packBytes;
+
+	for (int asset = 0; asset < g_PackManifestCount; asset++)
+	{
+		std::vector<unsigned char> fileBytes;
+		if (ReadWholeFile(g_PackManifest[asset], fileBytes) == false)
+		{
+			std::cout << "WARNING: Skipping missing asset "
+				<< g_PackManifest[asset] << std::endl;
+			continue;
+		}
+
+		// every asset's bytes start on an aligned boundary so
+		// slices can be handed to parsers directly
+		while ((packBytes.size() % g_AssetAlignment) != 0)
+		{
+			packBytes.push_back(0);
+		}
+
+		PACK_ENTRY entry;
+#if defined(_MSC_VER)
+		strncpy_s(entry.name, g_PackManifest[asset], g_MaxAssetNameLength - 1);
+#else
+		strncpy(entry.name, g_PackManifest[asset], g_MaxAssetNameLength - 1);
+#endif
+		entry.byteOffset = (uint64_t)packBytes.size();
+		entry.byteSize = (uint64_t)fileBytes.size();
+		entries.push_back(entry);
+
+		packBytes.insert(packBytes.end(), fileBytes.begin(), fileBytes.end());
+
+		std::cout << "INFO: Packed " << g_PackManifest[asset]
+			<< " (" << fileBytes.size() << " bytes)" << std::endl;
+	}
+
+	if (entries.empty())
+	{
+		std::cout << "WARNING: No assets found - pack not written" << std::endl;
+		return(false);
+	}
+
+	// the asset offsets recorded above are relative to the data
+	// section, which starts aligned after the entry table
+	size_t dataSectionStart =
+		sizeof(PACK_HEADER) + entries.size() * sizeof(PACK_ENTRY);
+	while ((dataSectionStart % g_AssetAlignment) != 0)
+	{
+		dataSectionStart++;
+	}
+	for (size_t entry = 0; entry < entries.size(); entry++)
+	{
+		entries[entry].byteOffset += (uint64_t)dataSectionStart;
+	}
+
+	FILE* pFile = NULL;
+#if defined(_MSC_VER)
+	fopen_s(&pFile, packFilename, "wb");
+#else
+	pFile = fopen(packFilename, "wb");
+#endif
+	if (NULL == pFile)
+	{
+		std::cout << "WARNING: Could not write asset pack "
+			<< packFilename << std::endl;
+		return(false);
+	}
+
+	PACK_HEADER header;
+	header.magic = g_PackMagic;
+	header.version = g_PackVersion;
+	header.assetCount = (uint32_t)entries.size();
+
+	fwrite(&header, sizeof(header), 1, pFile);
+	fwrite(entries.data(), sizeof(PACK_ENTRY), entries.size(), pFile);
+
+	// pad out to the aligned data section start
+	size_t bytesWritten =
+		sizeof(PACK_HEADER) + entries.size() * sizeof(PACK_ENTRY);
+	const unsigned char zeroByte = 0;
+	while (bytesWritten < dataSectionStart)
+	{
+		fwrite(&zeroByte, 1, 1, pFile);
+		bytesWritten++;
+	}
+
+	fwrite(packBytes.data(), 1, packBytes.size(), pFile);
+	fclose(pFile);
+
+	std::cout << "INFO: Wrote asset pack " << packFilename
+		<< " with " << entries.size() << " assets" << std::endl;
+
+	return(true);
+}
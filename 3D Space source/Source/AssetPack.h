@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// bundles the application's assets - textures, shader sources, scene
+// data - into one aligned archive file, mapped once at startup and
+// served as zero-copy slices, so loading never pays per-file open and
+// stat overhead or depends on the working directory layout
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class AssetPack
+{
+public:
+	// access to the single shared instance
+	static AssetPack& Instance();
+
+	// map the archive into memory - returns false when the
+	// file is missing or malformed, and the loaders then fall
+	// back to loose files
+	bool Mount(const char* packFilename);
+
+	// true once an archive has been mounted
+	bool IsMounted() const;
+
+	// look up an asset by the path it would have as a loose
+	// file - the returned pointer is a zero-copy slice into
+	// the mapped archive, valid for the lifetime of the mount
+	bool GetAsset(
+		const char* assetName,
+		const unsigned char*& assetData,
+		size_t& assetSize) const;
+
+	// the offline builder - bundles the application's asset
+	// manifest into the archive; run with the --pack command
+	// line flag, no GL context needed
+	static bool BuildPack(const char* packFilename);
+
+private:
+	AssetPack() {}
+	~AssetPack();
+
+	// one entry of the mounted directory
+	struct ASSET_ENTRY
+	{
+		size_t byteOffset = 0;
+		size_t byteSize = 0;
+	};
+
+	// the mapped archive bytes
+	const unsigned char* m_packData = nullptr;
+	size_t m_packSize = 0;
+
+	// directory from asset name to archive slice
+	std::unordered_map<std::string, ASSET_ENTRY> m_assetDirectory;
+
+#if defined(_WIN32)
+	// the file mapping backing m_packData
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#else
+	// without a mapping the archive is read once into here
+	std::vector<unsigned char> m_packBytes;
+#endif
+};
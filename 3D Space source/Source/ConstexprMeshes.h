@@ -0,0 +1,336 @@
+///////////////////////////////////////////////////////////////////////////////
+// constexprmeshes.h
+// ============
+// compile-time tessellation of the curved primitives - the sphere, torus
+// and conic shapes are generated by constexpr constructors parameterized
+// by their segment counts, so every detail level's vertex and index data
+// is stamped out by the compiler into static constant data and startup
+// reduces to copying the tables into the shared mesh buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ConstexprMeshes
+{
+	constexpr double CT_PI = 3.14159265358979323846;
+
+	// number of floats in one interleaved vertex - position,
+	// normal, texture coordinate - matching the vertex layout
+	// of the shared mesh buffers
+	constexpr int CT_FLOATS_PER_VERTEX = 8;
+
+	/*******************************************************
+	 *  CtSqrt()
+	 *
+	 *  This function is a constexpr square root - Newton
+	 *  iteration, only ever evaluated by the compiler.
+	 *******************************************************/
+	constexpr float CtSqrt(float value)
+	{
+		double guess = (value > 1.0f) ? (double)value : 1.0;
+		for (int iteration = 0; iteration < 32; iteration++)
+		{
+			guess = 0.5 * (guess + (double)value / guess);
+		}
+		return((float)guess);
+	}
+
+	/*******************************************************
+	 *  CtSin()
+	 *
+	 *  This function is a constexpr sine - the angle is
+	 *  reduced into [-pi/2, pi/2] and evaluated with a
+	 *  Taylor polynomial in double precision.
+	 *******************************************************/
+	constexpr float CtSin(float radians)
+	{
+		double x = (double)radians;
+		while (x > CT_PI)
+		{
+			x -= 2.0 * CT_PI;
+		}
+		while (x < -CT_PI)
+		{
+			x += 2.0 * CT_PI;
+		}
+		if (x > (CT_PI * 0.5))
+		{
+			x = CT_PI - x;
+		}
+		else if (x < -(CT_PI * 0.5))
+		{
+			x = -CT_PI - x;
+		}
+
+		double x2 = x * x;
+		double result = x * (1.0 - x2 / 6.0 *
+			(1.0 - x2 / 20.0 *
+			(1.0 - x2 / 42.0 *
+			(1.0 - x2 / 72.0 *
+			(1.0 - x2 / 110.0)))));
+		return((float)result);
+	}
+
+	/*******************************************************
+	 *  CtCos()
+	 *
+	 *  This function is a constexpr cosine via the shifted
+	 *  sine.
+	 *******************************************************/
+	constexpr float CtCos(float radians)
+	{
+		return(CtSin(radians + (float)(CT_PI * 0.5)));
+	}
+
+	// a sphere of unit radius centered on the origin,
+	// tessellated at compile time into SEGMENTS slices by
+	// STACKS stacks - the layout matches the runtime
+	// generators exactly
+	template <int SEGMENTS, int STACKS>
+	struct SPHERE_MESH
+	{
+		static constexpr int VERTEX_COUNT = (STACKS + 1) * (SEGMENTS + 1);
+		static constexpr int VERTEX_FLOAT_COUNT = VERTEX_COUNT * CT_FLOATS_PER_VERTEX;
+		static constexpr int INDEX_COUNT = STACKS * SEGMENTS * 6;
+
+		float vertexData[VERTEX_FLOAT_COUNT] = {};
+		unsigned int indexData[INDEX_COUNT] = {};
+
+		constexpr SPHERE_MESH()
+		{
+			int vertexFloat = 0;
+			for (int stack = 0; stack <= STACKS; stack++)
+			{
+				float stackAngle = (float)stack / (float)STACKS * (float)CT_PI;
+				float y = CtCos(stackAngle);
+				float stackRadius = CtSin(stackAngle);
+
+				for (int segment = 0; segment <= SEGMENTS; segment++)
+				{
+					float angle = (float)segment / (float)SEGMENTS * 2.0f * (float)CT_PI;
+					float x = CtCos(angle) * stackRadius;
+					float z = CtSin(angle) * stackRadius;
+
+					// on a unit sphere the position is the normal
+					vertexData[vertexFloat++] = x;
+					vertexData[vertexFloat++] = y;
+					vertexData[vertexFloat++] = z;
+					vertexData[vertexFloat++] = x;
+					vertexData[vertexFloat++] = y;
+					vertexData[vertexFloat++] = z;
+					vertexData[vertexFloat++] = (float)segment / (float)SEGMENTS;
+					vertexData[vertexFloat++] = 1.0f - (float)stack / (float)STACKS;
+				}
+			}
+
+			int index = 0;
+			for (int stack = 0; stack < STACKS; stack++)
+			{
+				for (int segment = 0; segment < SEGMENTS; segment++)
+				{
+					unsigned int ringIndex = stack * (SEGMENTS + 1) + segment;
+					unsigned int nextRingIndex = ringIndex + SEGMENTS + 1;
+
+					indexData[index++] = ringIndex;
+					indexData[index++] = nextRingIndex;
+					indexData[index++] = ringIndex + 1;
+					indexData[index++] = ringIndex + 1;
+					indexData[index++] = nextRingIndex;
+					indexData[index++] = nextRingIndex + 1;
+				}
+			}
+		}
+	};
+
+	// a torus with a ring radius of one and a tube radius of
+	// 0.2, centered on the origin, tessellated at compile time
+	// into RINGS ring segments by SIDES tube sides
+	template <int RINGS, int SIDES>
+	struct TORUS_MESH
+	{
+		static constexpr int VERTEX_COUNT = (RINGS + 1) * (SIDES + 1);
+		static constexpr int VERTEX_FLOAT_COUNT = VERTEX_COUNT * CT_FLOATS_PER_VERTEX;
+		static constexpr int INDEX_COUNT = RINGS * SIDES * 6;
+
+		float vertexData[VERTEX_FLOAT_COUNT] = {};
+		unsigned int indexData[INDEX_COUNT] = {};
+
+		constexpr TORUS_MESH()
+		{
+			constexpr float ringRadius = 1.0f;
+			constexpr float tubeRadius = 0.2f;
+
+			int vertexFloat = 0;
+			for (int ring = 0; ring <= RINGS; ring++)
+			{
+				float ringAngle = (float)ring / (float)RINGS * 2.0f * (float)CT_PI;
+				float ringCos = CtCos(ringAngle);
+				float ringSin = CtSin(ringAngle);
+
+				for (int side = 0; side <= SIDES; side++)
+				{
+					float sideAngle = (float)side / (float)SIDES * 2.0f * (float)CT_PI;
+					float sideCos = CtCos(sideAngle);
+					float sideSin = CtSin(sideAngle);
+
+					float normalX = ringCos * sideCos;
+					float normalY = sideSin;
+					float normalZ = ringSin * sideCos;
+
+					vertexData[vertexFloat++] = ringCos * ringRadius + normalX * tubeRadius;
+					vertexData[vertexFloat++] = normalY * tubeRadius;
+					vertexData[vertexFloat++] = ringSin * ringRadius + normalZ * tubeRadius;
+					vertexData[vertexFloat++] = normalX;
+					vertexData[vertexFloat++] = normalY;
+					vertexData[vertexFloat++] = normalZ;
+					vertexData[vertexFloat++] = (float)ring / (float)RINGS;
+					vertexData[vertexFloat++] = (float)side / (float)SIDES;
+				}
+			}
+
+			int index = 0;
+			for (int ring = 0; ring < RINGS; ring++)
+			{
+				for (int side = 0; side < SIDES; side++)
+				{
+					unsigned int ringIndex = ring * (SIDES + 1) + side;
+					unsigned int nextRingIndex = ringIndex + SIDES + 1;
+
+					indexData[index++] = ringIndex;
+					indexData[index++] = ringIndex + 1;
+					indexData[index++] = nextRingIndex;
+					indexData[index++] = ringIndex + 1;
+					indexData[index++] = nextRingIndex + 1;
+					indexData[index++] = nextRingIndex;
+				}
+			}
+		}
+	};
+
+	// the side surface and optional cap discs shared by the
+	// cone and the cylinder variants, tessellated at compile
+	// time - the base sits at y = 0 and the shape is one unit
+	// tall; the radii stay constructor arguments so one
+	// template covers every conic shape
+	template <int SEGMENTS, bool BOTTOM_CAP, bool TOP_CAP>
+	struct CONIC_MESH
+	{
+		static constexpr int CAP_COUNT = (BOTTOM_CAP ? 1 : 0) + (TOP_CAP ? 1 : 0);
+		static constexpr int VERTEX_COUNT =
+			(SEGMENTS + 1) * 2 + CAP_COUNT * (SEGMENTS + 2);
+		static constexpr int VERTEX_FLOAT_COUNT = VERTEX_COUNT * CT_FLOATS_PER_VERTEX;
+		static constexpr int INDEX_COUNT =
+			SEGMENTS * 6 + CAP_COUNT * SEGMENTS * 3;
+
+		float vertexData[VERTEX_FLOAT_COUNT] = {};
+		unsigned int indexData[INDEX_COUNT] = {};
+
+		constexpr CONIC_MESH(float bottomRadius, float topRadius)
+		{
+			// the slant of the side surface tilts the normals
+			// upward by the radius change over the height
+			float normalSlope = bottomRadius - topRadius;
+			float inverseNormalLength =
+				1.0f / CtSqrt(1.0f + normalSlope * normalSlope);
+
+			int vertexFloat = 0;
+			int index = 0;
+
+			// side surface - two rings sharing slanted normals
+			for (int segment = 0; segment <= SEGMENTS; segment++)
+			{
+				float angle = (float)segment / (float)SEGMENTS * 2.0f * (float)CT_PI;
+				float cosAngle = CtCos(angle);
+				float sinAngle = CtSin(angle);
+				float u = (float)segment / (float)SEGMENTS;
+
+				float normalX = cosAngle * inverseNormalLength;
+				float normalY = normalSlope * inverseNormalLength;
+				float normalZ = sinAngle * inverseNormalLength;
+
+				vertexData[vertexFloat++] = cosAngle * bottomRadius;
+				vertexData[vertexFloat++] = 0.0f;
+				vertexData[vertexFloat++] = sinAngle * bottomRadius;
+				vertexData[vertexFloat++] = normalX;
+				vertexData[vertexFloat++] = normalY;
+				vertexData[vertexFloat++] = normalZ;
+				vertexData[vertexFloat++] = u;
+				vertexData[vertexFloat++] = 0.0f;
+
+				vertexData[vertexFloat++] = cosAngle * topRadius;
+				vertexData[vertexFloat++] = 1.0f;
+				vertexData[vertexFloat++] = sinAngle * topRadius;
+				vertexData[vertexFloat++] = normalX;
+				vertexData[vertexFloat++] = normalY;
+				vertexData[vertexFloat++] = normalZ;
+				vertexData[vertexFloat++] = u;
+				vertexData[vertexFloat++] = 1.0f;
+			}
+			for (int segment = 0; segment < SEGMENTS; segment++)
+			{
+				unsigned int ringIndex = segment * 2;
+				indexData[index++] = ringIndex;
+				indexData[index++] = ringIndex + 1;
+				indexData[index++] = ringIndex + 2;
+				indexData[index++] = ringIndex + 1;
+				indexData[index++] = ringIndex + 3;
+				indexData[index++] = ringIndex + 2;
+			}
+
+			// bottom and top cap discs
+			for (int cap = 0; cap < 2; cap++)
+			{
+				if ((cap == 0) && (BOTTOM_CAP == false))
+					continue;
+				if ((cap == 1) && (TOP_CAP == false))
+					continue;
+
+				float y = (cap == 0) ? 0.0f : 1.0f;
+				float radius = (cap == 0) ? bottomRadius : topRadius;
+				float normalY = (cap == 0) ? -1.0f : 1.0f;
+
+				unsigned int centerIndex =
+					(unsigned int)(vertexFloat / CT_FLOATS_PER_VERTEX);
+				vertexData[vertexFloat++] = 0.0f;
+				vertexData[vertexFloat++] = y;
+				vertexData[vertexFloat++] = 0.0f;
+				vertexData[vertexFloat++] = 0.0f;
+				vertexData[vertexFloat++] = normalY;
+				vertexData[vertexFloat++] = 0.0f;
+				vertexData[vertexFloat++] = 0.5f;
+				vertexData[vertexFloat++] = 0.5f;
+
+				for (int segment = 0; segment <= SEGMENTS; segment++)
+				{
+					float angle = (float)segment / (float)SEGMENTS * 2.0f * (float)CT_PI;
+					float cosAngle = CtCos(angle);
+					float sinAngle = CtSin(angle);
+
+					vertexData[vertexFloat++] = cosAngle * radius;
+					vertexData[vertexFloat++] = y;
+					vertexData[vertexFloat++] = sinAngle * radius;
+					vertexData[vertexFloat++] = 0.0f;
+					vertexData[vertexFloat++] = normalY;
+					vertexData[vertexFloat++] = 0.0f;
+					vertexData[vertexFloat++] = cosAngle * 0.5f + 0.5f;
+					vertexData[vertexFloat++] = sinAngle * 0.5f + 0.5f;
+				}
+				for (int segment = 0; segment < SEGMENTS; segment++)
+				{
+					if (cap == 0)
+					{
+						indexData[index++] = centerIndex;
+						indexData[index++] = centerIndex + 1 + segment;
+						indexData[index++] = centerIndex + 2 + segment;
+					}
+					else
+					{
+						indexData[index++] = centerIndex;
+						indexData[index++] = centerIndex + 2 + segment;
+						indexData[index++] = centerIndex + 1 + segment;
+					}
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// a bump allocator for per-frame transient render data - allocations are
+// a single pointer bump out of one block that is reset at the start of
+// every frame, so steady-state rendering performs zero heap allocations
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared frame arena used
+ *  by all of the per-frame render code.
+ ***********************************************************/
+FrameArena& FrameArena::Instance()
+{
+	static FrameArena instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method reserves the arena block - one allocation at
+ *  startup that every frame afterwards bump-allocates from.
+ ***********************************************************/
+void FrameArena::Create(size_t capacityBytes)
+{
+	m_arenaBytes.resize(capacityBytes);
+	m_bytesUsed.store(0);
+	m_highWaterMark = 0;
+
+	std::cout << "INFO: Frame arena reserved "
+		<< (capacityBytes / 1024) << "KB" << std::endl;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method reclaims every allocation from the last
+ *  frame by rewinding the bump offset - nothing is freed,
+ *  so the reset cost does not grow with the frame.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	size_t bytesUsed = m_bytesUsed.load();
+	if (bytesUsed > m_highWaterMark)
+	{
+		m_highWaterMark = bytesUsed;
+	}
+
+	m_bytesUsed.store(0);
+
+	// trim any heap spill the last frame needed
+	if (m_overflowBlocks.empty() == false)
+	{
+		std::lock_guard<std::mutex> lock(m_overflowMutex);
+		for (size_t block = 0; block < m_overflowBlocks.size(); block++)
+		{
+			delete[] m_overflowBlocks[block];
+		}
+		m_overflowBlocks.clear();
+	}
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method hands out transient bytes valid until the
+ *  next Reset() - one atomic add on the bump offset, safe
+ *  from the job system's workers; a frame that outgrows the
+ *  block spills to the heap with a one-time warning.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t byteCount)
+{
+	// round up so every returned pointer stays aligned
+	byteCount = (byteCount + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+	size_t byteOffset = m_bytesUsed.fetch_add(byteCount);
+	if ((byteOffset + byteCount) <= m_arenaBytes.size())
+	{
+		return(m_arenaBytes.data() + byteOffset);
+	}
+
+	// the block is exhausted - spill this allocation to the
+	// heap so the frame still completes, and say so once
+	unsigned char* overflowBlock = new unsigned char[byteCount];
+	{
+		std::lock_guard<std::mutex> lock(m_overflowMutex);
+		m_overflowBlocks.push_back(overflowBlock);
+		if (m_bOverflowWarned == false)
+		{
+			std::cout << "WARNING: Frame arena exhausted at "
+				<< (m_arenaBytes.size() / 1024)
+				<< "KB - spilling to the heap" << std::endl;
+			m_bOverflowWarned = true;
+		}
+	}
+
+	return(overflowBlock);
+}
+
+/***********************************************************
+ *  GetHighWaterMark()
+ *
+ *  This method returns the most bytes any frame has
+ *  allocated so far.
+ ***********************************************************/
+size_t FrameArena::GetHighWaterMark() const
+{
+	return(m_highWaterMark);
+}
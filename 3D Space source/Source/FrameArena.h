@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// a bump allocator for per-frame transient render data - allocations are
+// a single pointer bump out of one block that is reset at the start of
+// every frame, so steady-state rendering performs zero heap allocations
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class FrameArena
+{
+public:
+	// access to the single shared instance
+	static FrameArena& Instance();
+
+	// reserve the arena block - call once at startup, before
+	// the first frame allocates
+	void Create(size_t capacityBytes = DEFAULT_CAPACITY_BYTES);
+
+	// reclaim every allocation from the last frame - call once
+	// per frame, before any render data is recorded; nothing is
+	// freed, the bump offset just rewinds to zero
+	void Reset();
+
+	// allocate transient bytes valid until the next Reset() -
+	// a single atomic bump, safe to call from the job system's
+	// workers; the rare frame that outgrows the block spills to
+	// the heap and is trimmed at the next reset
+	void* Allocate(size_t byteCount);
+
+	// typed array allocation out of the arena - the memory is
+	// uninitialized, only trivially copyable records belong here
+	template <typename RECORD_TYPE>
+	RECORD_TYPE* AllocateArray(size_t recordCount)
+	{
+		return((RECORD_TYPE*)Allocate(recordCount * sizeof(RECORD_TYPE)));
+	}
+
+	// the most bytes any frame has allocated, for sizing checks
+	size_t GetHighWaterMark() const;
+
+private:
+	FrameArena() {}
+
+	// default block size - comfortably above what a frame of the
+	// current scene records
+	static const size_t DEFAULT_CAPACITY_BYTES = 4 * 1024 * 1024;
+
+	// every allocation is rounded up to this alignment, so any
+	// record type can live at any returned pointer
+	static const size_t ARENA_ALIGNMENT = 16;
+
+	// the arena block and the bump offset into it
+	std::vector<unsigned char> m_arenaBytes;
+	std::atomic<size_t> m_bytesUsed{ 0 };
+	size_t m_highWaterMark = 0;
+
+	// heap spill for frames that outgrow the block - freed at
+	// the next reset, with a warning so the block gets resized
+	std::mutex m_overflowMutex;
+	std::vector<unsigned char*> m_overflowBlocks;
+	bool m_bOverflowWarned = false;
+};
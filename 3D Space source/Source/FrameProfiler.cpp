@@ -0,0 +1,411 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// per-frame performance instrumentation - CPU timers and GPU timer
+// queries around each render phase, rolling min/avg/p99 statistics,
+// draw call and state change counters, a live readout in the window
+// title bar, and a CSV report written on exit
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+// declaration of global variables
+namespace
+{
+	// number of recent frames the rolling statistics cover
+	const int g_SampleWindowSize = 240;
+
+	// seconds between refreshes of the title bar readout
+	const double g_TitleUpdateInterval = 1.0;
+
+	// display names for the instrumented phases
+	const char* g_PhaseNames[FrameProfiler::PHASE_COUNT] =
+	{
+		"view",
+		"render",
+		"swap"
+	};
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared frame profiler
+ *  used by all of the rendering code.
+ ***********************************************************/
+FrameProfiler& FrameProfiler::Instance()
+{
+	static FrameProfiler instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method creates the double buffered GPU timer query
+ *  objects for every instrumented phase.
+ ***********************************************************/
+void FrameProfiler::Create()
+{
+	glGenQueries(PHASE_COUNT, m_gpuQueries[0]);
+	glGenQueries(PHASE_COUNT, m_gpuQueries[1]);
+
+	// keep a long session from growing the report vector one
+	// reallocation at a time
+	m_frameHistory.reserve(16384);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method starts the timing of one render loop
+ *  iteration and clears the per-frame counters.
+ ***********************************************************/
+void FrameProfiler::BeginFrame()
+{
+	m_currentFrame = FRAME_RECORD();
+	m_frameStartTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  BeginPhase()
+ *
+ *  This method starts the CPU timer and the GPU time
+ *  elapsed query for the passed in phase.
+ ***********************************************************/
+void FrameProfiler::BeginPhase(PHASE phase)
+{
+	m_phaseStartTime[phase] = std::chrono::steady_clock::now();
+	glBeginQuery(GL_TIME_ELAPSED, m_gpuQueries[m_queryFrameIndex][phase]);
+}
+
+/***********************************************************
+ *  EndPhase()
+ *
+ *  This method stops the CPU timer and the GPU time
+ *  elapsed query for the passed in phase.
+ ***********************************************************/
+void FrameProfiler::EndPhase(PHASE phase)
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	m_gpuQueryIssued[m_queryFrameIndex][phase] = true;
+
+	std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::steady_clock::now() - m_phaseStartTime[phase];
+	m_currentFrame.cpuMilliseconds[phase] = elapsed.count();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method finishes the timing of one render loop
+ *  iteration - the GPU query results from the previous
+ *  frame are read back so the readback never stalls, the
+ *  frame record is stored, and the title bar readout is
+ *  refreshed about once per second.
+ ***********************************************************/
+void FrameProfiler::EndFrame(GLFWwindow* pWindow)
+{
+	std::chrono::duration<double, std::milli> frameElapsed =
+		std::chrono::steady_clock::now() - m_frameStartTime;
+	m_currentFrame.frameMilliseconds = frameElapsed.count();
+
+	// collect the GPU times the previous frame's queries
+	// measured - they are a frame old, which is fine for
+	// statistics and avoids waiting on the GPU
+	int previousIndex = 1 - m_queryFrameIndex;
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		if (m_gpuQueryIssued[previousIndex][phase] == true)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(
+				m_gpuQueries[previousIndex][phase],
+				GL_QUERY_RESULT, &nanoseconds);
+			m_currentFrame.gpuMilliseconds[phase] = (double)nanoseconds / 1000000.0;
+			m_gpuQueryIssued[previousIndex][phase] = false;
+		}
+	}
+	m_queryFrameIndex = previousIndex;
+
+	m_frameHistory.push_back(m_currentFrame);
+
+	UpdateTitleReadout(pWindow);
+}
+
+/***********************************************************
+ *  CountDrawCall()
+ *
+ *  This method adds one issued draw call to the current
+ *  frame's counter.
+ ***********************************************************/
+void FrameProfiler::CountDrawCall()
+{
+	m_currentFrame.drawCalls++;
+}
+
+/***********************************************************
+ *  CountStateChange()
+ *
+ *  This method adds one actually issued GL state change to
+ *  the current frame's counter.
+ ***********************************************************/
+void FrameProfiler::CountStateChange()
+{
+	m_currentFrame.stateChanges++;
+}
+
+/***********************************************************
+ *  ComputeStats()
+ *
+ *  This method computes the min/avg/p99 statistics over the
+ *  passed in millisecond samples.
+ ***********************************************************/
+FrameProfiler::PHASE_STATS FrameProfiler::ComputeStats(std::vector<double>& samples)
+{
+	PHASE_STATS stats;
+
+	if (samples.empty() == true)
+	{
+		return(stats);
+	}
+
+	double total = 0.0;
+	for (double sample : samples)
+	{
+		total += sample;
+	}
+	stats.avgMilliseconds = total / (double)samples.size();
+
+	size_t p99Index = (samples.size() * 99) / 100;
+	if (p99Index >= samples.size())
+	{
+		p99Index = samples.size() - 1;
+	}
+	std::nth_element(samples.begin(), samples.begin() + p99Index, samples.end());
+	stats.p99Milliseconds = samples[p99Index];
+	stats.minMilliseconds = *std::min_element(samples.begin(), samples.end());
+
+	return(stats);
+}
+
+/***********************************************************
+ *  GetCpuStats()
+ *
+ *  This method returns the rolling CPU time statistics for
+ *  the passed in phase.
+ ***********************************************************/
+FrameProfiler::PHASE_STATS FrameProfiler::GetCpuStats(PHASE phase) const
+{
+	std::vector<double> samples;
+	size_t firstFrame = (m_frameHistory.size() > (size_t)g_SampleWindowSize) ?
+		m_frameHistory.size() - g_SampleWindowSize : 0;
+	for (size_t index = firstFrame; index < m_frameHistory.size(); index++)
+	{
+		samples.push_back(m_frameHistory[index].cpuMilliseconds[phase]);
+	}
+
+	return(ComputeStats(samples));
+}
+
+/***********************************************************
+ *  GetGpuStats()
+ *
+ *  This method returns the rolling GPU time statistics for
+ *  the passed in phase.
+ ***********************************************************/
+FrameProfiler::PHASE_STATS FrameProfiler::GetGpuStats(PHASE phase) const
+{
+	std::vector<double> samples;
+	size_t firstFrame = (m_frameHistory.size() > (size_t)g_SampleWindowSize) ?
+		m_frameHistory.size() - g_SampleWindowSize : 0;
+	for (size_t index = firstFrame; index < m_frameHistory.size(); index++)
+	{
+		samples.push_back(m_frameHistory[index].gpuMilliseconds[phase]);
+	}
+
+	return(ComputeStats(samples));
+}
+
+/***********************************************************
+ *  UpdateTitleReadout()
+ *
+ *  This method refreshes the performance readout in the
+ *  window title bar about once per second - the project has
+ *  no text rendering, so the title bar serves as the live
+ *  on-screen overlay.
+ ***********************************************************/
+void FrameProfiler::UpdateTitleReadout(GLFWwindow* pWindow)
+{
+	if (NULL == pWindow)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (m_bTitleUpdateValid == true)
+	{
+		std::chrono::duration<double> sinceLastUpdate = now - m_lastTitleUpdate;
+		if (sinceLastUpdate.count() < g_TitleUpdateInterval)
+		{
+			return;
+		}
+	}
+	m_lastTitleUpdate = now;
+	m_bTitleUpdateValid = true;
+
+	// whole frame statistics over the rolling window
+	std::vector<double> frameSamples;
+	size_t firstFrame = (m_frameHistory.size() > (size_t)g_SampleWindowSize) ?
+		m_frameHistory.size() - g_SampleWindowSize : 0;
+	for (size_t index = firstFrame; index < m_frameHistory.size(); index++)
+	{
+		frameSamples.push_back(m_frameHistory[index].frameMilliseconds);
+	}
+	PHASE_STATS frameStats = ComputeStats(frameSamples);
+
+	PHASE_STATS renderCpu = GetCpuStats(PHASE_RENDER);
+	PHASE_STATS renderGpu = GetGpuStats(PHASE_RENDER);
+
+	const FRAME_RECORD& lastFrame = m_frameHistory.back();
+
+	char title[256];
+	snprintf(title, sizeof(title),
+		"7-1 FinalProject and Milestones | %.1f fps | frame %.2f ms (min %.2f p99 %.2f) | render cpu %.2f gpu %.2f ms | draws %d states %d",
+		(frameStats.avgMilliseconds > 0.0) ? 1000.0 / frameStats.avgMilliseconds : 0.0,
+		frameStats.avgMilliseconds,
+		frameStats.minMilliseconds,
+		frameStats.p99Milliseconds,
+		renderCpu.avgMilliseconds,
+		renderGpu.avgMilliseconds,
+		lastFrame.drawCalls,
+		lastFrame.stateChanges);
+	glfwSetWindowTitle(pWindow, title);
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method writes every recorded frame out to a CSV
+ *  file - one row per frame with the CPU and GPU time of
+ *  each phase and the per-frame counters.
+ ***********************************************************/
+void FrameProfiler::WriteReport(const char* reportFilename) const
+{
+	if (m_frameHistory.empty() == true)
+	{
+		return;
+	}
+
+	FILE* pReportFile = NULL;
+#if defined(_MSC_VER)
+	fopen_s(&pReportFile, reportFilename, "w");
+#else
+	pReportFile = fopen(reportFilename, "w");
+#endif
+	if (NULL == pReportFile)
+	{
+		std::cout << "Could not write performance report: " << reportFilename << std::endl;
+		return;
+	}
+
+	fprintf(pReportFile, "frame,total_cpu_ms");
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		fprintf(pReportFile, ",%s_cpu_ms,%s_gpu_ms",
+			g_PhaseNames[phase], g_PhaseNames[phase]);
+	}
+	fprintf(pReportFile, ",draw_calls,state_changes\n");
+
+	for (size_t index = 0; index < m_frameHistory.size(); index++)
+	{
+		const FRAME_RECORD& frameRecord = m_frameHistory[index];
+
+		fprintf(pReportFile, "%zu,%.4f", index, frameRecord.frameMilliseconds);
+		for (int phase = 0; phase < PHASE_COUNT; phase++)
+		{
+			fprintf(pReportFile, ",%.4f,%.4f",
+				frameRecord.cpuMilliseconds[phase],
+				frameRecord.gpuMilliseconds[phase]);
+		}
+		fprintf(pReportFile, ",%d,%d\n",
+			frameRecord.drawCalls, frameRecord.stateChanges);
+	}
+
+	fclose(pReportFile);
+	std::cout << "Performance report written: " << reportFilename
+		<< " (" << m_frameHistory.size() << " frames)" << std::endl;
+}
+
+/***********************************************************
+ *  PrintSummary()
+ *
+ *  This method prints the frames/sec, the per-phase timing
+ *  statistics, and the peak memory use of the process to
+ *  standard output.
+ ***********************************************************/
+void FrameProfiler::PrintSummary() const
+{
+	if (m_frameHistory.empty() == true)
+	{
+		return;
+	}
+
+	double totalMilliseconds = 0.0;
+	for (const FRAME_RECORD& frameRecord : m_frameHistory)
+	{
+		totalMilliseconds += frameRecord.frameMilliseconds;
+	}
+	double framesPerSecond = (totalMilliseconds > 0.0) ?
+		(double)m_frameHistory.size() * 1000.0 / totalMilliseconds : 0.0;
+
+	printf("\n=== Performance summary ===\n");
+	printf("frames:        %zu\n", m_frameHistory.size());
+	printf("total time:    %.2f s\n", totalMilliseconds / 1000.0);
+	printf("frames/sec:    %.1f\n", framesPerSecond);
+
+	// the summary covers the whole run, not just the rolling
+	// window the live readout uses
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		std::vector<double> cpuSamples;
+		std::vector<double> gpuSamples;
+		for (const FRAME_RECORD& frameRecord : m_frameHistory)
+		{
+			cpuSamples.push_back(frameRecord.cpuMilliseconds[phase]);
+			gpuSamples.push_back(frameRecord.gpuMilliseconds[phase]);
+		}
+		PHASE_STATS cpuStats = ComputeStats(cpuSamples);
+		PHASE_STATS gpuStats = ComputeStats(gpuSamples);
+
+		printf("%-8s cpu ms min %.3f avg %.3f p99 %.3f | gpu ms min %.3f avg %.3f p99 %.3f\n",
+			g_PhaseNames[phase],
+			cpuStats.minMilliseconds, cpuStats.avgMilliseconds, cpuStats.p99Milliseconds,
+			gpuStats.minMilliseconds, gpuStats.avgMilliseconds, gpuStats.p99Milliseconds);
+	}
+
+	const FRAME_RECORD& lastFrame = m_frameHistory.back();
+	printf("draw calls:    %d per frame\n", lastFrame.drawCalls);
+	printf("state changes: %d per frame\n", lastFrame.stateChanges);
+
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(),
+		&memoryCounters, sizeof(memoryCounters)) != 0)
+	{
+		printf("peak memory:   %.1f MB\n",
+			(double)memoryCounters.PeakWorkingSetSize / (1024.0 * 1024.0));
+	}
+#endif
+	printf("===========================\n");
+}
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// per-frame performance instrumentation - CPU timers and GPU timer
+// queries around each render phase, rolling min/avg/p99 statistics,
+// draw call and state change counters, a live readout in the window
+// title bar, and a CSV report written on exit
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+#include <vector>
+
+class FrameProfiler
+{
+public:
+	// the instrumented phases of the render loop
+	enum PHASE
+	{
+		PHASE_SCENE_VIEW,
+		PHASE_RENDER,
+		PHASE_SWAP,
+		PHASE_COUNT
+	};
+
+	// summary statistics over the rolling sample window
+	struct PHASE_STATS
+	{
+		double minMilliseconds = 0.0;
+		double avgMilliseconds = 0.0;
+		double p99Milliseconds = 0.0;
+	};
+
+	// access to the single shared instance
+	static FrameProfiler& Instance();
+
+	// create the GPU timer query objects - must be called once
+	// with an active GL context
+	void Create();
+
+	// bracket one iteration of the render loop
+	void BeginFrame();
+	void EndFrame(GLFWwindow* pWindow);
+
+	// bracket one render phase - phases must not overlap, GPU
+	// time elapsed queries cannot be nested
+	void BeginPhase(PHASE phase);
+	void EndPhase(PHASE phase);
+
+	// called by the rendering code whenever a draw call is
+	// issued or a piece of GL state is actually changed
+	void CountDrawCall();
+	void CountStateChange();
+
+	// compute the rolling statistics for one phase's CPU or
+	// GPU times over the sample window
+	PHASE_STATS GetCpuStats(PHASE phase) const;
+	PHASE_STATS GetGpuStats(PHASE phase) const;
+
+	// write every recorded frame out as CSV - called once when
+	// the application is shutting down
+	void WriteReport(const char* reportFilename) const;
+
+	// print the frames/sec, per-phase timing statistics, and
+	// peak memory use to standard output - used by the
+	// benchmark mode to report a finished run
+	void PrintSummary() const;
+
+private:
+	FrameProfiler() {}
+
+	// one recorded frame - CPU and GPU milliseconds per phase
+	// plus the per-frame counters
+	struct FRAME_RECORD
+	{
+		double cpuMilliseconds[PHASE_COUNT] = { 0.0 };
+		double gpuMilliseconds[PHASE_COUNT] = { 0.0 };
+		double frameMilliseconds = 0.0;
+		int drawCalls = 0;
+		int stateChanges = 0;
+	};
+
+	// compute min/avg/p99 over a set of millisecond samples
+	static PHASE_STATS ComputeStats(std::vector<double>& samples);
+
+	// update the live readout in the window title bar
+	void UpdateTitleReadout(GLFWwindow* pWindow);
+
+	// double buffered GPU timer queries - the result of frame N
+	// is read back while frame N+1 is being recorded, so the
+	// readback never stalls the pipeline
+	GLuint m_gpuQueries[2][PHASE_COUNT] = { { 0 }, { 0 } };
+	bool m_gpuQueryIssued[2][PHASE_COUNT] = { { false }, { false } };
+	int m_queryFrameIndex = 0;
+
+	// CPU timestamps for the phase currently being measured
+	std::chrono::steady_clock::time_point m_phaseStartTime[PHASE_COUNT];
+	std::chrono::steady_clock::time_point m_frameStartTime;
+
+	// the frame currently being recorded and the full history
+	FRAME_RECORD m_currentFrame;
+	std::vector<FRAME_RECORD> m_frameHistory;
+
+	// timestamp of the last title bar refresh
+	std::chrono::steady_clock::time_point m_lastTitleUpdate;
+	bool m_bTitleUpdateValid = false;
+};
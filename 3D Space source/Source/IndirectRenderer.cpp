@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////
+// indirectrenderer.cpp
+// ============
+// multi-draw-indirect submission path over the mesh library's shared
+// buffers - the visible objects of a frame become an array of indirect
+// draw commands plus a per-object shader storage buffer, and the whole
+// scene goes to the GPU with a single glMultiDrawElementsIndirect call
+///////////////////////////////////////////////////////////////////////////////
+
+#include "IndirectRenderer.h"
+
+#include "FrameProfiler.h"
+#include "ShaderCompiler.h"
+
+// declaration of global variables
+namespace
+{
+	// binding point of the per-object shader storage buffer
+	const GLuint g_PerObjectBindingPoint = 0;
+
+	// most draws one frame region of the streams can hold
+	const int g_MaxDrawsPerFrame = 4096;
+
+	// vertex shader for the indirect path - every per-draw
+	// value is read out of the per-object buffer by gl_DrawID,
+	// so nothing is uploaded between draws
+	const char* g_IndirectVertexSource = R"(
+#version 460 core
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out int drawIdentifier;
+
+layout(std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+struct PerObjectData
+{
+	mat4 model;
+	vec4 color;
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+	vec4 params;
+};
+
+layout(std430, binding = 0) readonly buffer PerObjectBuffer
+{
+	PerObjectData perObject[];
+};
+
+void main()
+{
+	PerObjectData objectData = perObject[gl_DrawID];
+
+	fragmentPosition = vec3(objectData.model * vec4(inVertexPosition, 1.0));
+	fragmentVertexNormal = mat3(transpose(inverse(objectData.model))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate * objectData.params.yz;
+	drawIdentifier = gl_DrawID;
+
+	gl_Position = projection * view * vec4(fragmentPosition, 1.0);
+}
+)";
+
+	// fragment shader for the indirect path - the lighting rig
+	// comes from the shared LightingBlock, the material and
+	// texture selection from the per-object buffer; textures
+	// are layers of the shared array, so one sampler covers
+	// every draw
+	const char* g_IndirectFragmentSource = R"(
+#version 460 core
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+flat in int drawIdentifier;
+
+out vec4 outFragmentColor;
+
+layout(std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+layout(std140, binding = 1) uniform LightingBlock
+{
+	vec4 dirLightDirection;
+	vec4 dirLightAmbient;
+	vec4 dirLightDiffuse;
+	vec4 spotLightPosition;
+	vec4 spotLightDirection;
+	vec4 spotLightAmbient;
+	vec4 spotLightDiffuse;
+	vec4 spotLightSpecular;
+	vec4 spotLightAttenuation;
+	vec4 spotLightCone;
+};
+
+struct PerObjectData
+{
+	mat4 model;
+	vec4 color;
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+	vec4 params;
+};
+
+layout(std430, binding = 0) readonly buffer PerObjectBuffer
+{
+	PerObjectData perObject[];
+};
+
+layout(binding = 0) uniform sampler2DArray objectTextureArray;
+
+void main()
+{
+	PerObjectData objectData = perObject[drawIdentifier];
+
+	vec3 normal = normalize(fragmentVertexNormal);
+	vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+
+	vec4 baseColor;
+	int textureLayer = int(objectData.params.x);
+	if (textureLayer >= 0)
+		baseColor = texture(objectTextureArray,
+			vec3(fragmentTextureCoordinate, float(textureLayer)));
+	else
+		baseColor = objectData.color;
+
+	// directional light contribution
+	vec3 lightDirection = normalize(-dirLightDirection.xyz);
+	float diffuseFactor = max(dot(normal, lightDirection), 0.0);
+	vec3 result = dirLightAmbient.rgb * objectData.ambient.w * objectData.ambient.rgb;
+	result += dirLightDiffuse.rgb * diffuseFactor * objectData.diffuse.rgb;
+
+	// spotlight contribution with smooth cone edges
+	vec3 spotDirection = normalize(spotLightPosition.xyz - fragmentPosition);
+	float theta = dot(spotDirection, normalize(-spotLightDirection.xyz));
+	float epsilon = spotLightCone.x - spotLightCone.y;
+	float intensity = clamp((theta - spotLightCone.y) / epsilon, 0.0, 1.0);
+
+	float distance = length(spotLightPosition.xyz - fragmentPosition);
+	float attenuation = 1.0 / (spotLightAttenuation.x + spotLightAttenuation.y * distance +
+		spotLightAttenuation.z * (distance * distance));
+
+	float spotDiffuseFactor = max(dot(normal, spotDirection), 0.0);
+	vec3 reflectDirection = reflect(-spotDirection, normal);
+	float specularFactor = pow(max(dot(viewDirection, reflectDirection), 0.0), objectData.diffuse.w);
+
+	result += spotLightAmbient.rgb * objectData.ambient.w * objectData.ambient.rgb;
+	result += spotLightDiffuse.rgb * spotDiffuseFactor * objectData.diffuse.rgb * intensity * attenuation;
+	result += spotLightSpecular.rgb * specularFactor * objectData.specular.rgb * intensity * attenuation;
+
+	outFragmentColor = vec4(result, 1.0) * baseColor;
+}
+)";
+}
+
+/***********************************************************
+ *  IndirectRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+IndirectRenderer::IndirectRenderer()
+{
+}
+
+/***********************************************************
+ *  ~IndirectRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+IndirectRenderer::~IndirectRenderer()
+{
+	if (m_programID != 0)
+	{
+		glDeleteProgram(m_programID);
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method compiles the indirect shader program and
+ *  creates the command and per-object buffers - the texture
+ *  array sampler carries its binding in the shader source.
+ ***********************************************************/
+void IndirectRenderer::Create()
+{
+	m_programID = ShaderCompiler::CompileProgram(
+		g_IndirectVertexSource, g_IndirectFragmentSource);
+
+	// one frame region holds the whole scene's commands and
+	// per-object records; three regions keep the CPU writes
+	// clear of the frames the GPU is still drawing
+	m_commandStream.Create(GL_DRAW_INDIRECT_BUFFER,
+		g_MaxDrawsPerFrame * sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND));
+	m_perObjectStream.Create(GL_SHADER_STORAGE_BUFFER,
+		g_MaxDrawsPerFrame * sizeof(PER_OBJECT_DATA));
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method starts collecting the draws of a new frame.
+ ***********************************************************/
+void IndirectRenderer::BeginFrame()
+{
+	m_commands.clear();
+	m_perObjectData.clear();
+}
+
+/***********************************************************
+ *  AddDraw()
+ *
+ *  This method appends one visible object to the frame's
+ *  command and per-object arrays.
+ ***********************************************************/
+void IndirectRenderer::AddDraw(
+	GLsizei indexCount,
+	size_t firstIndexByteOffset,
+	GLint baseVertex,
+	const PER_OBJECT_DATA& objectData)
+{
+	DRAW_ELEMENTS_INDIRECT_COMMAND command;
+	command.count = (GLuint)indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = (GLuint)(firstIndexByteOffset / sizeof(unsigned int));
+	command.baseVertex = (GLuint)baseVertex;
+	command.baseInstance = (GLuint)m_commands.size();
+
+	m_commands.push_back(command);
+	m_perObjectData.push_back(objectData);
+}
+
+/***********************************************************
+ *  SubmitFrame()
+ *
+ *  This method uploads the collected command and per-object
+ *  arrays once and draws them with one
+ *  glMultiDrawElementsIndirect call per viewport - the
+ *  callback rebinds each viewport's camera state, so extra
+ *  viewports only cost the GPU replay.
+ ***********************************************************/
+void IndirectRenderer::SubmitFrame(
+	MeshLibrary* pMeshLibrary,
+	int viewportCount,
+	const std::function<void(int)>& applyViewportFunction)
+{
+	if (m_commands.empty())
+	{
+		return;
+	}
+
+	// remember the caller's program so it can be restored
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+	glUseProgram(m_programID);
+
+	// write the frame straight into the persistently mapped
+	// streams - the only possible stall is the fence wait in
+	// BeginFrame() when the GPU is three frames behind
+	m_perObjectStream.BeginFrame();
+	m_commandStream.BeginFrame();
+
+	size_t perObjectByteOffset = 0;
+	size_t commandByteOffset = 0;
+	bool bFrameFits =
+		m_perObjectStream.Write(
+			m_perObjectData.data(),
+			m_perObjectData.size() * sizeof(PER_OBJECT_DATA),
+			perObjectByteOffset) &&
+		m_commandStream.Write(
+			m_commands.data(),
+			m_commands.size() * sizeof(DRAW_ELEMENTS_INDIRECT_COMMAND),
+			commandByteOffset);
+
+	if (bFrameFits == true)
+	{
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, g_PerObjectBindingPoint,
+			m_perObjectStream.GetBufferID(), perObjectByteOffset,
+			m_perObjectData.size() * sizeof(PER_OBJECT_DATA));
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandStream.GetBufferID());
+
+		pMeshLibrary->BindMeshes();
+		for (int viewport = 0; viewport < viewportCount; viewport++)
+		{
+			if (applyViewportFunction != nullptr)
+			{
+				applyViewportFunction(viewport);
+			}
+
+			glMultiDrawElementsIndirect(
+				GL_TRIANGLES, GL_UNSIGNED_INT,
+				(void*)commandByteOffset, (GLsizei)m_commands.size(), 0);
+
+			FrameProfiler::Instance().CountDrawCall();
+		}
+		pMeshLibrary->UnbindMeshes();
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	// the fences recorded here cover every viewport's
+	// submission, so the streams stay untouched until the last
+	// replay has drawn
+	m_perObjectStream.EndFrame();
+	m_commandStream.EndFrame();
+
+	glUseProgram((GLuint)previousProgram);
+}
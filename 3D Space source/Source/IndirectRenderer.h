@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// indirectrenderer.h
+// ============
+// multi-draw-indirect submission path over the mesh library's shared
+// buffers - the visible objects of a frame become an array of indirect
+// draw commands plus a per-object shader storage buffer, and the whole
+// scene goes to the GPU with a single glMultiDrawElementsIndirect call
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+#include "MeshLibrary.h"
+#include "StreamBuffer.h"
+
+class IndirectRenderer
+{
+public:
+	// everything one draw needs, indexed by gl_DrawID in the
+	// shaders - std430 layout, padded to vec4 boundaries
+	struct PER_OBJECT_DATA
+	{
+		glm::mat4 model;
+		// used when no texture index is set
+		glm::vec4 color;
+		// rgb ambient color, w ambient strength
+		glm::vec4 ambient;
+		// rgb diffuse color, w shininess
+		glm::vec4 diffuse;
+		// rgb specular color, w unused
+		glm::vec4 specular;
+		// x texture array layer (negative for solid color), yz UV scale
+		glm::vec4 params;
+	};
+
+	// constructor
+	IndirectRenderer();
+	// destructor
+	~IndirectRenderer();
+
+	// compile the indirect shader program and create the
+	// command and per-object buffers - needs a GL 4.6 context
+	// for gl_DrawID
+	void Create();
+
+	// start collecting the draws of a new frame
+	void BeginFrame();
+
+	// append one visible object - the mesh range comes from
+	// MeshLibrary::GetMeshRange()
+	void AddDraw(
+		GLsizei indexCount,
+		size_t firstIndexByteOffset,
+		GLint baseVertex,
+		const PER_OBJECT_DATA& objectData);
+
+	// upload the collected commands once and submit them with
+	// one glMultiDrawElementsIndirect call per viewport - the
+	// callback rebinds the viewport's camera state before each
+	// submission, so extra viewports never pay the record or
+	// upload cost again
+	void SubmitFrame(
+		MeshLibrary* pMeshLibrary,
+		int viewportCount = 1,
+		const std::function<void(int)>& applyViewportFunction = nullptr);
+
+private:
+	// the command layout glMultiDrawElementsIndirect consumes
+	struct DRAW_ELEMENTS_INDIRECT_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLuint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// the shader program reading the per-object buffer
+	GLuint m_programID = 0;
+
+	// persistently mapped triple-buffered streams holding the
+	// frame's commands and per-object records - writes land
+	// straight in GPU visible memory, no per-frame transfer
+	StreamBuffer m_commandStream;
+	StreamBuffer m_perObjectStream;
+
+	// the CPU side arrays collected between BeginFrame() and
+	// SubmitFrame()
+	std::vector<DRAW_ELEMENTS_INDIRECT_COMMAND> m_commands;
+	std::vector<PER_OBJECT_DATA> m_perObjectData;
+};
@@ -0,0 +1,444 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.cpp
+// ============
+// instanced rendering path for repeated basic shapes - N copies of a
+// shape that differ only by model matrix are drawn with one call using
+// a per-instance matrix vertex buffer and an instanced shader program
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InstancedMeshes.h"
+
+#include <cmath>
+
+#include <glm/gtc/type_ptr.hpp>
+#include "FrameProfiler.h"
+#include "ShaderCompiler.h"
+
+// declaration of global variables
+namespace
+{
+	// number of segments around the tapered cylinder
+	const int g_SideSegments = 30;
+	// bottom/top radius and height matching the basic shape
+	const float g_BottomRadius = 0.5f;
+	const float g_TopRadius = 0.25f;
+	const float g_Height = 1.0f;
+
+	// vertex shader for the instanced path - the model matrix
+	// arrives as a per-instance vertex attribute instead of a
+	// per-draw uniform, and the camera state comes from the
+	// shared CameraBlock
+	const char* g_InstancedVertexSource = R"(
+#version 430 core
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+layout (location = 3) in mat4 inInstanceModel;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+layout(std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+uniform vec2 UVscale = vec2(1.0, 1.0);
+
+void main()
+{
+	fragmentPosition = vec3(inInstanceModel * vec4(inVertexPosition, 1.0));
+	fragmentVertexNormal = mat3(transpose(inverse(inInstanceModel))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate * UVscale;
+
+	gl_Position = projection * view * vec4(fragmentPosition, 1.0);
+}
+)";
+
+	// fragment shader for the instanced path - the lighting rig
+	// is read from the shared LightingBlock, so the instanced
+	// program always matches the scene program exactly
+	const char* g_InstancedFragmentSource = R"(
+#version 430 core
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+out vec4 outFragmentColor;
+
+struct Material
+{
+	vec3 ambientColor;
+	float ambientStrength;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float shininess;
+};
+
+layout(std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+layout(std140, binding = 1) uniform LightingBlock
+{
+	vec4 dirLightDirection;
+	vec4 dirLightAmbient;
+	vec4 dirLightDiffuse;
+	vec4 spotLightPosition;
+	vec4 spotLightDirection;
+	vec4 spotLightAmbient;
+	vec4 spotLightDiffuse;
+	vec4 spotLightSpecular;
+	vec4 spotLightAttenuation;
+	vec4 spotLightCone;
+};
+
+uniform bool bUseTexture;
+uniform vec4 objectColor;
+layout (binding = 0) uniform sampler2DArray objectTextureArray;
+uniform int textureLayer;
+uniform Material material;
+
+void main()
+{
+	vec3 normal = normalize(fragmentVertexNormal);
+	vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+
+	vec4 baseColor;
+	if (bUseTexture)
+		baseColor = texture(objectTextureArray,
+			vec3(fragmentTextureCoordinate, float(textureLayer)));
+	else
+		baseColor = objectColor;
+
+	// directional light contribution
+	vec3 lightDirection = normalize(-dirLightDirection.xyz);
+	float diffuseFactor = max(dot(normal, lightDirection), 0.0);
+	vec3 result = dirLightAmbient.rgb * material.ambientStrength * material.ambientColor;
+	result += dirLightDiffuse.rgb * diffuseFactor * material.diffuseColor;
+
+	// spotlight contribution with smooth cone edges
+	vec3 spotDirection = normalize(spotLightPosition.xyz - fragmentPosition);
+	float theta = dot(spotDirection, normalize(-spotLightDirection.xyz));
+	float epsilon = spotLightCone.x - spotLightCone.y;
+	float intensity = clamp((theta - spotLightCone.y) / epsilon, 0.0, 1.0);
+
+	float distance = length(spotLightPosition.xyz - fragmentPosition);
+	float attenuation = 1.0 / (spotLightAttenuation.x + spotLightAttenuation.y * distance +
+		spotLightAttenuation.z * (distance * distance));
+
+	float spotDiffuseFactor = max(dot(normal, spotDirection), 0.0);
+	vec3 reflectDirection = reflect(-spotDirection, normal);
+	float specularFactor = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
+
+	result += spotLightAmbient.rgb * material.ambientStrength * material.ambientColor;
+	result += spotLightDiffuse.rgb * spotDiffuseFactor * material.diffuseColor * intensity * attenuation;
+	result += spotLightSpecular.rgb * specularFactor * material.specularColor * intensity * attenuation;
+
+	outFragmentColor = vec4(result, 1.0) * baseColor;
+}
+)";
+}
+
+/***********************************************************
+ *  InstancedMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InstancedMeshes::InstancedMeshes()
+{
+}
+
+/***********************************************************
+ *  ~InstancedMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InstancedMeshes::~InstancedMeshes()
+{
+	if (m_vertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteBuffers(1, &m_indexBuffer);
+		glDeleteBuffers(1, &m_instanceBuffer);
+	}
+	if (m_programID != 0)
+	{
+		glDeleteProgram(m_programID);
+	}
+}
+
+/***********************************************************
+ *  GenerateTaperedCylinder()
+ *
+ *  This method generates the interleaved vertex data and
+ *  the index data for the tapered cylinder shape - position,
+ *  normal, and texture coordinate per vertex.
+ ***********************************************************/
+void InstancedMeshes::GenerateTaperedCylinder(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData)
+{
+	const float PI = 3.1415926535f;
+
+	// the slant of the side surface tilts the normals upward
+	// by the radius change over the height
+	float normalSlope = (g_BottomRadius - g_TopRadius) / g_Height;
+
+	auto pushVertex = [&](glm::vec3 position, glm::vec3 normal, glm::vec2 uv)
+	{
+		vertexData.push_back(position.x);
+		vertexData.push_back(position.y);
+		vertexData.push_back(position.z);
+		vertexData.push_back(normal.x);
+		vertexData.push_back(normal.y);
+		vertexData.push_back(normal.z);
+		vertexData.push_back(uv.x);
+		vertexData.push_back(uv.y);
+	};
+
+	// side surface - two rings sharing slanted normals
+	unsigned int sideBase = 0;
+	for (int segment = 0; segment <= g_SideSegments; segment++)
+	{
+		float angle = (float)segment / (float)g_SideSegments * 2.0f * PI;
+		float cosAngle = cos(angle);
+		float sinAngle = sin(angle);
+		float u = (float)segment / (float)g_SideSegments;
+
+		glm::vec3 normal = glm::normalize(glm::vec3(cosAngle, normalSlope, sinAngle));
+
+		pushVertex(
+			glm::vec3(cosAngle * g_BottomRadius, 0.0f, sinAngle * g_BottomRadius),
+			normal, glm::vec2(u, 0.0f));
+		pushVertex(
+			glm::vec3(cosAngle * g_TopRadius, g_Height, sinAngle * g_TopRadius),
+			normal, glm::vec2(u, 1.0f));
+	}
+	for (int segment = 0; segment < g_SideSegments; segment++)
+	{
+		unsigned int ringIndex = sideBase + segment * 2;
+		indexData.push_back(ringIndex);
+		indexData.push_back(ringIndex + 1);
+		indexData.push_back(ringIndex + 2);
+		indexData.push_back(ringIndex + 1);
+		indexData.push_back(ringIndex + 3);
+		indexData.push_back(ringIndex + 2);
+	}
+
+	// bottom and top cap discs
+	for (int cap = 0; cap < 2; cap++)
+	{
+		float y = (cap == 0) ? 0.0f : g_Height;
+		float radius = (cap == 0) ? g_BottomRadius : g_TopRadius;
+		glm::vec3 normal = (cap == 0) ?
+			glm::vec3(0.0f, -1.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+		unsigned int centerIndex = (unsigned int)(vertexData.size() / 8);
+		pushVertex(glm::vec3(0.0f, y, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+
+		for (int segment = 0; segment <= g_SideSegments; segment++)
+		{
+			float angle = (float)segment / (float)g_SideSegments * 2.0f * PI;
+			float cosAngle = cos(angle);
+			float sinAngle = sin(angle);
+
+			pushVertex(
+				glm::vec3(cosAngle * radius, y, sinAngle * radius),
+				normal,
+				glm::vec2(cosAngle * 0.5f + 0.5f, sinAngle * 0.5f + 0.5f));
+		}
+		for (int segment = 0; segment < g_SideSegments; segment++)
+		{
+			indexData.push_back(centerIndex);
+			if (cap == 0)
+			{
+				indexData.push_back(centerIndex + 1 + segment);
+				indexData.push_back(centerIndex + 2 + segment);
+			}
+			else
+			{
+				indexData.push_back(centerIndex + 2 + segment);
+				indexData.push_back(centerIndex + 1 + segment);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  LoadTaperedCylinderMesh()
+ *
+ *  This method generates the tapered cylinder mesh data,
+ *  creates the vertex array with the per-instance model
+ *  matrix attribute, and compiles the instanced shader.
+ ***********************************************************/
+void InstancedMeshes::LoadTaperedCylinderMesh()
+{
+	std::vector<float> vertexData;
+	std::vector<unsigned int> indexData;
+	GenerateTaperedCylinder(vertexData, indexData);
+	m_indexCount = (int)indexData.size();
+
+	glGenVertexArrays(1, &m_vertexArray);
+	glBindVertexArray(m_vertexArray);
+
+	glGenBuffers(1, &m_vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER,
+		vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+		indexData.size() * sizeof(unsigned int), indexData.data(), GL_STATIC_DRAW);
+
+	// position, normal, texture coordinate
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+
+	// the per-instance model matrix occupies four consecutive
+	// attribute locations, advancing once per instance
+	glGenBuffers(1, &m_instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	for (int column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE,
+			sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	glBindVertexArray(0);
+
+	m_programID = ShaderCompiler::CompileProgram(
+		g_InstancedVertexSource, g_InstancedFragmentSource);
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method sets the material values that the next
+ *  instanced draw will use.
+ ***********************************************************/
+void InstancedMeshes::SetMaterial(
+	glm::vec3 ambientColor,
+	float ambientStrength,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float shininess)
+{
+	m_ambientColor = ambientColor;
+	m_ambientStrength = ambientStrength;
+	m_diffuseColor = diffuseColor;
+	m_specularColor = specularColor;
+	m_shininess = shininess;
+}
+
+/***********************************************************
+ *  SetTexture()
+ *
+ *  This method sets the texture slot that the next instanced
+ *  draw will sample from, or -1 for solid color.
+ ***********************************************************/
+void InstancedMeshes::SetTexture(int textureSlot)
+{
+	m_textureSlot = textureSlot;
+}
+
+/***********************************************************
+ *  SetColor()
+ *
+ *  This method sets the solid color used when no texture
+ *  slot has been set.
+ ***********************************************************/
+void InstancedMeshes::SetColor(glm::vec4 color)
+{
+	m_color = color;
+}
+
+/***********************************************************
+ *  PrepareProgramState()
+ *
+ *  This method sends the material and texture state into the
+ *  instanced shader program - the camera and lighting state
+ *  arrive through the shared uniform blocks, so only the
+ *  per-batch values are uploaded here.
+ ***********************************************************/
+void InstancedMeshes::PrepareProgramState()
+{
+	auto setVec3 = [this](const char* name, const glm::vec3& value)
+	{
+		glUniform3fv(glGetUniformLocation(m_programID, name), 1, glm::value_ptr(value));
+	};
+	auto setFloat = [this](const char* name, float value)
+	{
+		glUniform1f(glGetUniformLocation(m_programID, name), value);
+	};
+	auto setInt = [this](const char* name, int value)
+	{
+		glUniform1i(glGetUniformLocation(m_programID, name), value);
+	};
+
+	setVec3("material.ambientColor", m_ambientColor);
+	setFloat("material.ambientStrength", m_ambientStrength);
+	setVec3("material.diffuseColor", m_diffuseColor);
+	setVec3("material.specularColor", m_specularColor);
+	setFloat("material.shininess", m_shininess);
+
+	if (m_textureSlot >= 0)
+	{
+		setInt("bUseTexture", 1);
+		setInt("textureLayer", m_textureSlot);
+	}
+	else
+	{
+		setInt("bUseTexture", 0);
+		glUniform4fv(glGetUniformLocation(m_programID, "objectColor"), 1, glm::value_ptr(m_color));
+	}
+}
+
+/***********************************************************
+ *  DrawTaperedCylinderMeshInstanced()
+ *
+ *  This method draws count copies of the tapered cylinder
+ *  with a single instanced draw call, one copy per model
+ *  matrix in the passed in array.
+ ***********************************************************/
+void InstancedMeshes::DrawTaperedCylinderMeshInstanced(const glm::mat4* models, int count)
+{
+	if ((m_programID == 0) || (count <= 0))
+	{
+		return;
+	}
+
+	// remember the caller's program so it can be restored
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+	glUseProgram(m_programID);
+	PrepareProgramState();
+
+	// re-fill the per-instance matrix buffer, orphaning the
+	// previous frame's storage so the upload never stalls
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, count * sizeof(glm::mat4), models, GL_STREAM_DRAW);
+
+	glBindVertexArray(m_vertexArray);
+	glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0, count);
+	glBindVertexArray(0);
+
+	FrameProfiler::Instance().CountDrawCall();
+
+	glUseProgram((GLuint)previousProgram);
+}
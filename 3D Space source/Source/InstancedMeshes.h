@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// instancedmeshes.h
+// ============
+// instanced rendering path for repeated basic shapes - N copies of a
+// shape that differ only by model matrix are drawn with one call using
+// a per-instance matrix vertex buffer and an instanced shader program
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class InstancedMeshes
+{
+public:
+	InstancedMeshes();
+	~InstancedMeshes();
+
+	// generate the instanced tapered cylinder mesh and compile
+	// the instanced shader program - must be called once with
+	// an active OpenGL context before any draws
+	void LoadTaperedCylinderMesh();
+
+	// set the material values used by the next instanced draw
+	void SetMaterial(
+		glm::vec3 ambientColor,
+		float ambientStrength,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float shininess);
+
+	// set the texture slot used by the next instanced draw,
+	// or -1 to draw with the passed in solid color
+	void SetTexture(int textureSlot);
+	void SetColor(glm::vec4 color);
+
+	// draw count copies of the tapered cylinder, one instance
+	// per model matrix, with a single draw call - the caller's
+	// active shader program is restored afterwards
+	void DrawTaperedCylinderMeshInstanced(const glm::mat4* models, int count);
+
+private:
+	// build the vertex/index data for the tapered cylinder
+	void GenerateTaperedCylinder(
+		std::vector<float>& vertexData,
+		std::vector<unsigned int>& indexData);
+	// send the camera, lighting and material state into the
+	// instanced program before a draw
+	void PrepareProgramState();
+
+	GLuint m_programID = 0;
+	GLuint m_vertexArray = 0;
+	GLuint m_vertexBuffer = 0;
+	GLuint m_indexBuffer = 0;
+	// per-instance model matrix buffer, re-filled each draw
+	GLuint m_instanceBuffer = 0;
+	int m_indexCount = 0;
+
+	// state for the next draw
+	glm::vec3 m_ambientColor = glm::vec3(0.2f);
+	float m_ambientStrength = 0.5f;
+	glm::vec3 m_diffuseColor = glm::vec3(1.0f);
+	glm::vec3 m_specularColor = glm::vec3(0.0f);
+	float m_shininess = 1.0f;
+	int m_textureSlot = -1;
+	glm::vec4 m_color = glm::vec4(1.0f);
+};
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// worker thread pool for the CPU side of the frame - data parallel work
+// like transform recomputes, visibility tests, and render command
+// recording is split into index ranges that the workers and the calling
+// thread chew through together, then the caller continues once every
+// range has finished
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared job system used
+ *  by all of the scene code.
+ ***********************************************************/
+JobSystem& JobSystem::Instance()
+{
+	static JobSystem instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_bShuttingDown = true;
+	}
+	m_jobAvailable.notify_all();
+
+	for (size_t worker = 0; worker < m_workers.size(); worker++)
+	{
+		if (m_workers[worker].joinable())
+		{
+			m_workers[worker].join();
+		}
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method spins up one worker thread per hardware
+ *  thread beyond the calling thread.
+ ***********************************************************/
+void JobSystem::Create()
+{
+	if (m_workers.empty() == false)
+	{
+		return;
+	}
+
+	int workerCount = (int)std::thread::hardware_concurrency() - 1;
+	if (workerCount < 0)
+	{
+		workerCount = 0;
+	}
+
+	for (int worker = 0; worker < workerCount; worker++)
+	{
+		// thread index 0 is the calling thread
+		m_workers.push_back(std::thread(
+			&JobSystem::WorkerLoop, this, worker + 1));
+	}
+
+	std::cout << "INFO: Job system running on " << GetThreadCount()
+		<< " threads" << std::endl;
+}
+
+/***********************************************************
+ *  GetThreadCount()
+ *
+ *  This method returns the number of threads a parallel
+ *  job runs on, including the calling thread.
+ ***********************************************************/
+int JobSystem::GetThreadCount() const
+{
+	return((int)m_workers.size() + 1);
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method splits [0, count) into chunks and runs the
+ *  job function over them on every thread at once - the
+ *  calling thread works too and returns once the whole
+ *  range has been processed.
+ ***********************************************************/
+void JobSystem::ParallelFor(int count, int minimumChunkSize, const JOB_FUNCTION& jobFunction)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// small ranges are not worth waking the pool for
+	if ((m_workers.empty() == true) || (count <= minimumChunkSize))
+	{
+		jobFunction(0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_jobFunction = jobFunction;
+		m_jobCount = count;
+		m_jobChunkSize = minimumChunkSize;
+		m_nextChunkStart.store(0);
+		m_activeWorkers.store((int)m_workers.size());
+		m_jobGeneration++;
+	}
+	m_jobAvailable.notify_all();
+
+	// the calling thread is thread index 0
+	RunChunks(0);
+
+	// wait for the workers to finish their remaining chunks -
+	// the spin here is short, every thread is on the same job
+	while (m_activeWorkers.load() > 0)
+	{
+		std::this_thread::yield();
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is the worker thread entry point - sleep
+ *  until a job arrives, run chunks of it, repeat.
+ ***********************************************************/
+void JobSystem::WorkerLoop(int threadIndex)
+{
+	unsigned int lastSeenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+			m_jobAvailable.wait(lock, [this, lastSeenGeneration]
+				{
+					return((m_jobGeneration != lastSeenGeneration) ||
+						(m_bShuttingDown == true));
+				});
+
+			if (m_bShuttingDown == true)
+			{
+				return;
+			}
+			lastSeenGeneration = m_jobGeneration;
+		}
+
+		RunChunks(threadIndex);
+		m_activeWorkers.fetch_sub(1);
+	}
+}
+
+/***********************************************************
+ *  RunChunks()
+ *
+ *  This method pulls chunks off the shared range until
+ *  none remain.
+ ***********************************************************/
+void JobSystem::RunChunks(int threadIndex)
+{
+	while (true)
+	{
+		int chunkStart = m_nextChunkStart.fetch_add(m_jobChunkSize);
+		if (chunkStart >= m_jobCount)
+		{
+			return;
+		}
+
+		int chunkEnd = chunkStart + m_jobChunkSize;
+		if (chunkEnd > m_jobCount)
+		{
+			chunkEnd = m_jobCount;
+		}
+
+		m_jobFunction(chunkStart, chunkEnd, threadIndex);
+	}
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// worker thread pool for the CPU side of the frame - data parallel work
+// like transform recomputes, visibility tests, and render command
+// recording is split into index ranges that the workers and the calling
+// thread chew through together, then the caller continues once every
+// range has finished
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+	// the job function receives an index range [begin, end)
+	// plus the index of the thread running it, for per-thread
+	// output lists
+	typedef std::function<void(int, int, int)> JOB_FUNCTION;
+
+	// access to the single shared instance
+	static JobSystem& Instance();
+
+	// spin up the worker threads - one per hardware thread
+	// beyond the calling thread
+	void Create();
+
+	// number of threads ParallelFor() runs on, including the
+	// calling thread - per-thread output lists size to this
+	int GetThreadCount() const;
+
+	// split [0, count) into chunks and run the job function
+	// over them on every thread at once - returns when the
+	// whole range has been processed; must not issue GL calls
+	// from inside the job, the GL context belongs to the
+	// calling thread
+	void ParallelFor(int count, int minimumChunkSize, const JOB_FUNCTION& jobFunction);
+
+private:
+	JobSystem() {}
+	~JobSystem();
+
+	// the worker thread entry point
+	void WorkerLoop(int threadIndex);
+
+	// run chunks of the current job until none remain
+	void RunChunks(int threadIndex);
+
+	std::vector<std::thread> m_workers;
+	bool m_bShuttingDown = false;
+
+	// the job currently being executed
+	JOB_FUNCTION m_jobFunction;
+	int m_jobCount = 0;
+	int m_jobChunkSize = 0;
+	std::atomic<int> m_nextChunkStart{ 0 };
+	std::atomic<int> m_activeWorkers{ 0 };
+
+	// workers sleep on this until a job arrives - the counter
+	// tells them a new job started
+	std::mutex m_jobMutex;
+	std::condition_variable m_jobAvailable;
+	unsigned int m_jobGeneration = 0;
+};
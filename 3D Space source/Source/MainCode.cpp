@@ -1,5 +1,6 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <string>           // command line parsing
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -9,10 +10,14 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "AssetPack.h"
+#include "FrameArena.h"
+#include "FrameProfiler.h"
+#include "JobSystem.h"
 #include "SceneManager.h"
+#include "ShaderVariants.h"
 #include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
+#include "UniformBlocks.h"
 
 // Namespace for declaring global variables
 namespace
@@ -25,10 +30,20 @@ namespace
 
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+
+	// when true the application renders a fixed number of
+	// frames along the scripted camera path with a hidden
+	// window, then reports the timings and exits
+	bool g_bBenchmarkMode = false;
+	int g_BenchmarkFrameCount = 1000;
+
+	// when true a frame is only rendered when the camera or the
+	// scene has changed since the last rendered frame - meant
+	// for static-viewpoint installs where redrawing an identical
+	// image just burns power
+	bool g_bRenderOnChange = false;
 }
 
 // Function declarations - all functions that are called manually
@@ -45,17 +60,74 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// --benchmark [N] renders N frames headless along the
+	// scripted camera path and reports the timings - used to
+	// validate performance between releases without a desktop
+	for (int argIndex = 1; argIndex < argc; argIndex++)
+	{
+		// --pack runs the offline archive builder and exits -
+		// no window or GL context is needed for it
+		if (std::string(argv[argIndex]) == "--pack")
+		{
+			bool bPacked = AssetPack::BuildPack("assets.pak");
+			return(bPacked ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		// --render-on-change skips frames while nothing moves -
+		// see the idle branch at the top of the render loop
+		if (std::string(argv[argIndex]) == "--render-on-change")
+		{
+			g_bRenderOnChange = true;
+		}
+		// --split-screen renders the operator view beside a
+		// fixed overview of the scene - one shared traversal,
+		// re-submitted per viewport
+		if (std::string(argv[argIndex]) == "--split-screen")
+		{
+			ViewManager::EnableSplitScreen();
+		}
+		// --vram-budget <MB> caps the texture array allocation
+		// - the layer resolution is halved until everything
+		// fits, so memory-constrained GPUs never page mid-frame
+		if (std::string(argv[argIndex]) == "--vram-budget")
+		{
+			if ((argIndex + 1) < argc)
+			{
+				int budgetMegabytes = atoi(argv[argIndex + 1]);
+				if (budgetMegabytes > 0)
+				{
+					TextureArray::SetVRAMBudget(budgetMegabytes);
+					argIndex++;
+				}
+			}
+		}
+		if (std::string(argv[argIndex]) == "--benchmark")
+		{
+			g_bBenchmarkMode = true;
+			if ((argIndex + 1) < argc)
+			{
+				int frameCount = atoi(argv[argIndex + 1]);
+				if (frameCount > 0)
+				{
+					g_BenchmarkFrameCount = frameCount;
+					argIndex++;
+				}
+			}
+		}
+	}
+
+	// mount the asset archive once - every loader serves its
+	// assets as slices of the mapping and falls back to loose
+	// files when no archive has been built
+	AssetPack::Instance().Mount("assets.pak");
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
 	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+	g_ViewManager = new ViewManager();
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
@@ -66,20 +138,89 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../../Utilities/shaders/vertexShader.glsl",
-		"../../../Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	// create the shared camera and lighting uniform buffers
+	// before any shader program is used
+	UniformBlocks::Instance().Create();
+
+	// create the GPU timer queries for the frame profiler
+	FrameProfiler::Instance().Create();
+
+	// spin up the worker pool for the CPU side of the frame
+	JobSystem::Instance().Create();
+
+	// reserve the bump arena that backs the per-frame render
+	// records - reset at the top of every frame
+	FrameArena::Instance().Create();
+
+	// compile the specialized permutations of the scene shader
+	// from the GLSL files - these live in the project folder so
+	// they can declare the shared uniform blocks; every draw
+	// then runs a branch-free program instead of testing the
+	// old bUseTexture/bUseLighting flags per pixel
+	if (ShaderVariants::Instance().Create(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl") == false)
+	{
+		return(EXIT_FAILURE);
+	}
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager();
 	g_SceneManager->PrepareScene();
 
-	// loop will keep running until the application is closed 
+	if (g_bBenchmarkMode == true)
+	{
+		// uncap the frame rate and put the camera onto the
+		// scripted orbit so every run renders the same frames
+		glfwSwapInterval(0);
+		ViewManager::EnableBenchmarkMode();
+		std::cout << "INFO: Benchmark mode - rendering "
+			<< g_BenchmarkFrameCount << " frames" << std::endl;
+	}
+	else
+	{
+		// camera movement runs on its own fixed-rate thread so
+		// input stays smooth when a render frame runs long
+		g_ViewManager->StartUpdateThread();
+
+		if (g_bRenderOnChange == true)
+		{
+			std::cout << "INFO: Render-on-change mode - frames are "
+				<< "skipped while the view and scene are static" << std::endl;
+		}
+	}
+
+	// loop will keep running until the application is closed
 	// or until an error has occurred
+	int framesRendered = 0;
 	while (!glfwWindowShouldClose(g_Window))
 	{
+		if ((g_bBenchmarkMode == true) &&
+			(framesRendered >= g_BenchmarkFrameCount))
+		{
+			break;
+		}
+		// render-on-change mode: when neither the camera nor the
+		// scene has changed since the last rendered frame, keep
+		// the previous image on screen and sleep on the event
+		// queue instead of redrawing - the timeout keeps held
+		// keys and the async texture pipeline serviced
+		if ((g_bRenderOnChange == true) && (g_bBenchmarkMode == false))
+		{
+			g_ViewManager->SampleInputEvents();
+			if ((g_SceneManager->IsSceneDirty() == false) &&
+				(ViewManager::IsViewDirty() == false))
+			{
+				glfwWaitEventsTimeout(0.1);
+				continue;
+			}
+		}
+
+		FrameProfiler::Instance().BeginFrame();
+
+		// reclaim last frame's transient render allocations
+		FrameArena::Instance().Reset();
+
 		// Enable z-depth
 		glEnable(GL_DEPTH_TEST);
 
@@ -87,18 +228,39 @@ int main(int argc, char* argv[])
 		glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// upload any texture decodes the worker threads finished
+		g_SceneManager->UpdateAsyncTextureLoads();
+
 		// convert from 3D object space to 2D view
+		FrameProfiler::Instance().BeginPhase(FrameProfiler::PHASE_SCENE_VIEW);
 		g_ViewManager->PrepareSceneView();
+		FrameProfiler::Instance().EndPhase(FrameProfiler::PHASE_SCENE_VIEW);
 
 		// refresh the 3D scene
+		FrameProfiler::Instance().BeginPhase(FrameProfiler::PHASE_RENDER);
 		g_SceneManager->RenderScene();
+		FrameProfiler::Instance().EndPhase(FrameProfiler::PHASE_RENDER);
 
 
 		// Flips the the back buffer with the front buffer every frame.
+		FrameProfiler::Instance().BeginPhase(FrameProfiler::PHASE_SWAP);
 		glfwSwapBuffers(g_Window);
+		FrameProfiler::Instance().EndPhase(FrameProfiler::PHASE_SWAP);
 
 		// query the latest GLFW events
 		glfwPollEvents();
+
+		FrameProfiler::Instance().EndFrame(g_Window);
+		framesRendered++;
+	}
+
+	// dump the per-frame timings recorded over the session
+	FrameProfiler::Instance().WriteReport("perf_report.csv");
+
+	// report the finished benchmark run on standard output
+	if (g_bBenchmarkMode == true)
+	{
+		FrameProfiler::Instance().PrintSummary();
 	}
 
 	// clear the allocated manager objects from memory
@@ -112,11 +274,6 @@ int main(int argc, char* argv[])
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
 
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
@@ -144,6 +301,13 @@ bool InitializeGLFW()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #endif
+
+	// the benchmark runs offscreen - the context and window
+	// are still created, they are just never shown
+	if (g_bBenchmarkMode == true)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
 	// GLFW: end -------------------------------
 
 	return(true);
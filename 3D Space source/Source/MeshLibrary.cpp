@@ -0,0 +1,592 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.cpp
+// ============
+// consolidated storage for all of the basic 3D shapes - every primitive
+// is packed into one interleaved vertex buffer and one index buffer
+// sharing a single vertex array, and each shape is drawn with a
+// glDrawElementsBaseVertex into the shared buffers so drawing a
+// different shape never rebinds a vertex array
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshLibrary.h"
+
+#include <cmath>
+
+#include "ConstexprMeshes.h"
+#include "FrameProfiler.h"
+
+// declaration of global variables
+namespace
+{
+	const float g_Pi = 3.1415926535f;
+
+	// number of segments used for the curved shapes at each
+	// detail level - level 0 is the original full tessellation;
+	// these feed the template parameters below, so every detail
+	// level is tessellated at compile time
+	constexpr int g_LodSideSegments[MeshLibrary::LOD_LEVEL_COUNT] = { 30, 14, 6 };
+	constexpr int g_LodSphereStacks[MeshLibrary::LOD_LEVEL_COUNT] = { 30, 14, 6 };
+	constexpr int g_LodTorusSides[MeshLibrary::LOD_LEVEL_COUNT] = { 20, 10, 6 };
+
+	// the curved shapes stamped out by the compiler, one
+	// instance per detail level - startup only copies these
+	// tables into the shared staging buffers
+	constexpr ConstexprMeshes::SPHERE_MESH<g_LodSideSegments[0], g_LodSphereStacks[0]> g_SphereMesh0;
+	constexpr ConstexprMeshes::SPHERE_MESH<g_LodSideSegments[1], g_LodSphereStacks[1]> g_SphereMesh1;
+	constexpr ConstexprMeshes::SPHERE_MESH<g_LodSideSegments[2], g_LodSphereStacks[2]> g_SphereMesh2;
+
+	constexpr ConstexprMeshes::TORUS_MESH<g_LodSideSegments[0], g_LodTorusSides[0]> g_TorusMesh0;
+	constexpr ConstexprMeshes::TORUS_MESH<g_LodSideSegments[1], g_LodTorusSides[1]> g_TorusMesh1;
+	constexpr ConstexprMeshes::TORUS_MESH<g_LodSideSegments[2], g_LodTorusSides[2]> g_TorusMesh2;
+
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[0], true, false> g_ConeMesh0(1.0f, 0.0f);
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[1], true, false> g_ConeMesh1(1.0f, 0.0f);
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[2], true, false> g_ConeMesh2(1.0f, 0.0f);
+
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[0], true, true> g_TaperedCylinderMesh0(0.5f, 0.25f);
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[1], true, true> g_TaperedCylinderMesh1(0.5f, 0.25f);
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[2], true, true> g_TaperedCylinderMesh2(0.5f, 0.25f);
+
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[0], true, true> g_CylinderMesh0(1.0f, 1.0f);
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[1], true, true> g_CylinderMesh1(1.0f, 1.0f);
+	constexpr ConstexprMeshes::CONIC_MESH<g_LodSideSegments[2], true, true> g_CylinderMesh2(1.0f, 1.0f);
+
+	/*******************************************************
+	 *  AppendMesh()
+	 *
+	 *  This function copies one compile-time tessellated
+	 *  mesh into the passed in staging buffers.
+	 *******************************************************/
+	template <typename MESH_TYPE>
+	void AppendMesh(
+		const MESH_TYPE& mesh,
+		std::vector<float>& vertexData,
+		std::vector<unsigned int>& indexData)
+	{
+		vertexData.insert(vertexData.end(),
+			mesh.vertexData, mesh.vertexData + MESH_TYPE::VERTEX_FLOAT_COUNT);
+		indexData.insert(indexData.end(),
+			mesh.indexData, mesh.indexData + MESH_TYPE::INDEX_COUNT);
+	}
+
+	// which shapes have a curved surface worth retessellating -
+	// the flat shapes are identical at every detail level
+	const bool g_bMeshIsCurved[MeshLibrary::MESH_ID_COUNT] =
+	{
+		false,	// plane
+		false,	// box
+		true,	// cone
+		false,	// prism
+		false,	// pyramid3
+		true,	// sphere
+		true,	// torus
+		true,	// tapered cylinder
+		true,	// cylinder
+	};
+
+	// number of floats in one interleaved vertex - position,
+	// normal, texture coordinate
+	const int g_FloatsPerVertex = 8;
+
+	/*******************************************************
+	 *  PushVertex()
+	 *
+	 *  This function appends one interleaved vertex to the
+	 *  passed in vertex data.
+	 *******************************************************/
+	void PushVertex(
+		std::vector<float>& vertexData,
+		glm::vec3 position,
+		glm::vec3 normal,
+		glm::vec2 uv)
+	{
+		vertexData.push_back(position.x);
+		vertexData.push_back(position.y);
+		vertexData.push_back(position.z);
+		vertexData.push_back(normal.x);
+		vertexData.push_back(normal.y);
+		vertexData.push_back(normal.z);
+		vertexData.push_back(uv.x);
+		vertexData.push_back(uv.y);
+	}
+
+	/*******************************************************
+	 *  PushTriangle()
+	 *
+	 *  This function appends one triangle to the passed in
+	 *  index data.
+	 *******************************************************/
+	void PushTriangle(
+		std::vector<unsigned int>& indexData,
+		unsigned int index0,
+		unsigned int index1,
+		unsigned int index2)
+	{
+		indexData.push_back(index0);
+		indexData.push_back(index1);
+		indexData.push_back(index2);
+	}
+
+	/*******************************************************
+	 *  PushQuad()
+	 *
+	 *  This function appends four corner vertices sharing
+	 *  one normal plus the two triangles between them.
+	 *******************************************************/
+	void PushQuad(
+		std::vector<float>& vertexData,
+		std::vector<unsigned int>& indexData,
+		glm::vec3 corner0,
+		glm::vec3 corner1,
+		glm::vec3 corner2,
+		glm::vec3 corner3,
+		glm::vec3 normal)
+	{
+		unsigned int baseIndex = (unsigned int)(vertexData.size() / g_FloatsPerVertex);
+
+		PushVertex(vertexData, corner0, normal, glm::vec2(0.0f, 0.0f));
+		PushVertex(vertexData, corner1, normal, glm::vec2(1.0f, 0.0f));
+		PushVertex(vertexData, corner2, normal, glm::vec2(1.0f, 1.0f));
+		PushVertex(vertexData, corner3, normal, glm::vec2(0.0f, 1.0f));
+
+		PushTriangle(indexData, baseIndex, baseIndex + 1, baseIndex + 2);
+		PushTriangle(indexData, baseIndex, baseIndex + 2, baseIndex + 3);
+	}
+}
+
+/***********************************************************
+ *  MeshLibrary()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshLibrary::MeshLibrary()
+{
+}
+
+/***********************************************************
+ *  ~MeshLibrary()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshLibrary::~MeshLibrary()
+{
+	if (m_vertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
+}
+
+/***********************************************************
+ *  LoadMeshes()
+ *
+ *  This method generates every basic shape, packs the data
+ *  into one interleaved vertex buffer and one index buffer,
+ *  and records where each shape lives so DrawMesh() can
+ *  issue a glDrawElementsBaseVertex into the shared buffers.
+ ***********************************************************/
+void MeshLibrary::LoadMeshes()
+{
+	std::vector<float> vertexData;
+	std::vector<unsigned int> indexData;
+
+	// the generators in MESH_ID order - the curved shapes only
+	// copy their compile-time tables at the requested level
+	void (*generators[MESH_ID_COUNT])(std::vector<float>&, std::vector<unsigned int>&, int) =
+	{
+		GeneratePlane,
+		GenerateBox,
+		GenerateCone,
+		GeneratePrism,
+		GeneratePyramid3,
+		GenerateSphere,
+		GenerateTorus,
+		GenerateTaperedCylinder,
+		GenerateCylinder
+	};
+
+	for (int meshID = 0; meshID < MESH_ID_COUNT; meshID++)
+	{
+		for (int lodLevel = 0; lodLevel < LOD_LEVEL_COUNT; lodLevel++)
+		{
+			// flat shapes look the same at every detail level, so
+			// the reduced levels alias the full one instead of
+			// storing duplicate geometry
+			if ((lodLevel > 0) && (g_bMeshIsCurved[meshID] == false))
+			{
+				m_meshRanges[meshID][lodLevel] = m_meshRanges[meshID][0];
+				continue;
+			}
+
+			// every shape's indexes are local to the shape - the
+			// base vertex recorded here is added by the draw call
+			m_meshRanges[meshID][lodLevel].baseVertex =
+				(GLint)(vertexData.size() / g_FloatsPerVertex);
+			m_meshRanges[meshID][lodLevel].firstIndexByteOffset =
+				indexData.size() * sizeof(unsigned int);
+
+			std::vector<float> shapeVertexData;
+			std::vector<unsigned int> shapeIndexData;
+			generators[meshID](shapeVertexData, shapeIndexData, lodLevel);
+
+			m_meshRanges[meshID][lodLevel].indexCount = (GLsizei)shapeIndexData.size();
+
+			vertexData.insert(vertexData.end(),
+				shapeVertexData.begin(), shapeVertexData.end());
+			indexData.insert(indexData.end(),
+				shapeIndexData.begin(), shapeIndexData.end());
+		}
+	}
+
+	glGenVertexArrays(1, &m_vertexArray);
+	glBindVertexArray(m_vertexArray);
+
+	glGenBuffers(1, &m_vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER,
+		vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+		indexData.size() * sizeof(unsigned int), indexData.data(), GL_STATIC_DRAW);
+
+	// position, normal, texture coordinate
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+		g_FloatsPerVertex * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE,
+		g_FloatsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE,
+		g_FloatsPerVertex * sizeof(float), (void*)(6 * sizeof(float)));
+
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  BindMeshes()
+ *
+ *  This method binds the shared vertex array - done once
+ *  around a run of DrawMesh() calls.
+ ***********************************************************/
+void MeshLibrary::BindMeshes()
+{
+	glBindVertexArray(m_vertexArray);
+}
+
+/***********************************************************
+ *  UnbindMeshes()
+ *
+ *  This method unbinds the shared vertex array.
+ ***********************************************************/
+void MeshLibrary::UnbindMeshes()
+{
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method draws one shape out of the shared buffers at
+ *  the passed in detail level - the shared vertex array must
+ *  already be bound.
+ ***********************************************************/
+void MeshLibrary::DrawMesh(MESH_ID meshID, int lodLevel)
+{
+	const MESH_RANGE& meshRange = m_meshRanges[meshID][lodLevel];
+
+	glDrawElementsBaseVertex(
+		GL_TRIANGLES,
+		meshRange.indexCount,
+		GL_UNSIGNED_INT,
+		(void*)meshRange.firstIndexByteOffset,
+		meshRange.baseVertex);
+
+	FrameProfiler::Instance().CountDrawCall();
+}
+
+/***********************************************************
+ *  GetMeshRange()
+ *
+ *  This method returns where the passed in shape's detail
+ *  level lives inside the shared buffers.
+ ***********************************************************/
+void MeshLibrary::GetMeshRange(
+	MESH_ID meshID,
+	int lodLevel,
+	GLsizei& indexCount,
+	size_t& firstIndexByteOffset,
+	GLint& baseVertex) const
+{
+	const MESH_RANGE& meshRange = m_meshRanges[meshID][lodLevel];
+
+	indexCount = meshRange.indexCount;
+	firstIndexByteOffset = meshRange.firstIndexByteOffset;
+	baseVertex = meshRange.baseVertex;
+}
+
+/***********************************************************
+ *  GeneratePlane()
+ *
+ *  This method generates a 2 x 2 plane in the XZ plane at
+ *  y = 0, facing up.
+ ***********************************************************/
+void MeshLibrary::GeneratePlane(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int /*lodLevel*/)
+{
+	PushQuad(vertexData, indexData,
+		glm::vec3(-1.0f, 0.0f, 1.0f),
+		glm::vec3(1.0f, 0.0f, 1.0f),
+		glm::vec3(1.0f, 0.0f, -1.0f),
+		glm::vec3(-1.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/***********************************************************
+ *  GenerateBox()
+ *
+ *  This method generates a unit cube centered on the
+ *  origin, four vertices per face for hard edges.
+ ***********************************************************/
+void MeshLibrary::GenerateBox(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int /*lodLevel*/)
+{
+	const float h = 0.5f;
+
+	// front
+	PushQuad(vertexData, indexData,
+		glm::vec3(-h, -h, h), glm::vec3(h, -h, h),
+		glm::vec3(h, h, h), glm::vec3(-h, h, h),
+		glm::vec3(0.0f, 0.0f, 1.0f));
+	// back
+	PushQuad(vertexData, indexData,
+		glm::vec3(h, -h, -h), glm::vec3(-h, -h, -h),
+		glm::vec3(-h, h, -h), glm::vec3(h, h, -h),
+		glm::vec3(0.0f, 0.0f, -1.0f));
+	// left
+	PushQuad(vertexData, indexData,
+		glm::vec3(-h, -h, -h), glm::vec3(-h, -h, h),
+		glm::vec3(-h, h, h), glm::vec3(-h, h, -h),
+		glm::vec3(-1.0f, 0.0f, 0.0f));
+	// right
+	PushQuad(vertexData, indexData,
+		glm::vec3(h, -h, h), glm::vec3(h, -h, -h),
+		glm::vec3(h, h, -h), glm::vec3(h, h, h),
+		glm::vec3(1.0f, 0.0f, 0.0f));
+	// top
+	PushQuad(vertexData, indexData,
+		glm::vec3(-h, h, h), glm::vec3(h, h, h),
+		glm::vec3(h, h, -h), glm::vec3(-h, h, -h),
+		glm::vec3(0.0f, 1.0f, 0.0f));
+	// bottom
+	PushQuad(vertexData, indexData,
+		glm::vec3(-h, -h, -h), glm::vec3(h, -h, -h),
+		glm::vec3(h, -h, h), glm::vec3(-h, -h, h),
+		glm::vec3(0.0f, -1.0f, 0.0f));
+}
+
+/***********************************************************
+ *  GenerateCone()
+ *
+ *  This method copies the compile-time tessellated cone -
+ *  a base radius of one, one unit tall, base at y = 0.
+ ***********************************************************/
+void MeshLibrary::GenerateCone(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int lodLevel)
+{
+	switch (lodLevel)
+	{
+	case 0: AppendMesh(g_ConeMesh0, vertexData, indexData); break;
+	case 1: AppendMesh(g_ConeMesh1, vertexData, indexData); break;
+	default: AppendMesh(g_ConeMesh2, vertexData, indexData); break;
+	}
+}
+
+/***********************************************************
+ *  GeneratePrism()
+ *
+ *  This method generates a triangular prism one unit on
+ *  each side, centered on the origin, running along Z.
+ ***********************************************************/
+void MeshLibrary::GeneratePrism(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int /*lodLevel*/)
+{
+	const float h = 0.5f;
+
+	// the triangular cross section
+	glm::vec3 bottomLeft = glm::vec3(-h, -h, 0.0f);
+	glm::vec3 bottomRight = glm::vec3(h, -h, 0.0f);
+	glm::vec3 top = glm::vec3(0.0f, h, 0.0f);
+	glm::vec3 front = glm::vec3(0.0f, 0.0f, h);
+	glm::vec3 back = glm::vec3(0.0f, 0.0f, -h);
+
+	// front cap
+	unsigned int baseIndex = (unsigned int)(vertexData.size() / g_FloatsPerVertex);
+	PushVertex(vertexData, bottomLeft + front, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f));
+	PushVertex(vertexData, bottomRight + front, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(1.0f, 0.0f));
+	PushVertex(vertexData, top + front, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.5f, 1.0f));
+	PushTriangle(indexData, baseIndex, baseIndex + 1, baseIndex + 2);
+
+	// back cap
+	baseIndex = (unsigned int)(vertexData.size() / g_FloatsPerVertex);
+	PushVertex(vertexData, bottomRight + back, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f));
+	PushVertex(vertexData, bottomLeft + back, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(1.0f, 0.0f));
+	PushVertex(vertexData, top + back, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.5f, 1.0f));
+	PushTriangle(indexData, baseIndex, baseIndex + 1, baseIndex + 2);
+
+	// bottom face
+	PushQuad(vertexData, indexData,
+		bottomLeft + back, bottomRight + back,
+		bottomRight + front, bottomLeft + front,
+		glm::vec3(0.0f, -1.0f, 0.0f));
+
+	// the two slanted side faces
+	glm::vec3 leftNormal = glm::normalize(glm::vec3(-1.0f, 0.5f, 0.0f));
+	PushQuad(vertexData, indexData,
+		bottomLeft + front, top + front, top + back, bottomLeft + back,
+		leftNormal);
+
+	glm::vec3 rightNormal = glm::normalize(glm::vec3(1.0f, 0.5f, 0.0f));
+	PushQuad(vertexData, indexData,
+		bottomRight + back, top + back, top + front, bottomRight + front,
+		rightNormal);
+}
+
+/***********************************************************
+ *  GeneratePyramid3()
+ *
+ *  This method generates a three sided pyramid one unit
+ *  tall, centered on the origin.
+ ***********************************************************/
+void MeshLibrary::GeneratePyramid3(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int /*lodLevel*/)
+{
+	// the base triangle circumscribes a unit side length
+	const float circumRadius = 0.57735f;
+	glm::vec3 apex = glm::vec3(0.0f, 0.5f, 0.0f);
+
+	glm::vec3 baseCorners[3];
+	for (int corner = 0; corner < 3; corner++)
+	{
+		float angle = (float)corner / 3.0f * 2.0f * g_Pi - g_Pi * 0.5f;
+		baseCorners[corner] = glm::vec3(
+			cos(angle) * circumRadius, -0.5f, sin(angle) * circumRadius);
+	}
+
+	// base face
+	unsigned int baseIndex = (unsigned int)(vertexData.size() / g_FloatsPerVertex);
+	for (int corner = 0; corner < 3; corner++)
+	{
+		PushVertex(vertexData, baseCorners[corner],
+			glm::vec3(0.0f, -1.0f, 0.0f),
+			glm::vec2(baseCorners[corner].x + 0.5f, baseCorners[corner].z + 0.5f));
+	}
+	PushTriangle(indexData, baseIndex, baseIndex + 1, baseIndex + 2);
+
+	// the three slanted faces with flat normals
+	for (int face = 0; face < 3; face++)
+	{
+		glm::vec3 corner0 = baseCorners[face];
+		glm::vec3 corner1 = baseCorners[(face + 1) % 3];
+		glm::vec3 normal = glm::normalize(
+			glm::cross(corner0 - apex, corner1 - apex));
+
+		baseIndex = (unsigned int)(vertexData.size() / g_FloatsPerVertex);
+		PushVertex(vertexData, corner1, normal, glm::vec2(0.0f, 0.0f));
+		PushVertex(vertexData, corner0, normal, glm::vec2(1.0f, 0.0f));
+		PushVertex(vertexData, apex, normal, glm::vec2(0.5f, 1.0f));
+		PushTriangle(indexData, baseIndex, baseIndex + 1, baseIndex + 2);
+	}
+}
+
+/***********************************************************
+ *  GenerateSphere()
+ *
+ *  This method copies the compile-time tessellated unit
+ *  radius sphere centered on the origin.
+ ***********************************************************/
+void MeshLibrary::GenerateSphere(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int lodLevel)
+{
+	switch (lodLevel)
+	{
+	case 0: AppendMesh(g_SphereMesh0, vertexData, indexData); break;
+	case 1: AppendMesh(g_SphereMesh1, vertexData, indexData); break;
+	default: AppendMesh(g_SphereMesh2, vertexData, indexData); break;
+	}
+}
+
+/***********************************************************
+ *  GenerateTorus()
+ *
+ *  This method copies the compile-time tessellated torus -
+ *  a ring radius of one and a tube radius of 0.2, centered
+ *  on the origin.
+ ***********************************************************/
+void MeshLibrary::GenerateTorus(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int lodLevel)
+{
+	switch (lodLevel)
+	{
+	case 0: AppendMesh(g_TorusMesh0, vertexData, indexData); break;
+	case 1: AppendMesh(g_TorusMesh1, vertexData, indexData); break;
+	default: AppendMesh(g_TorusMesh2, vertexData, indexData); break;
+	}
+}
+
+/***********************************************************
+ *  GenerateTaperedCylinder()
+ *
+ *  This method copies the compile-time tessellated tapered
+ *  cylinder - one unit tall with a 0.5 bottom and 0.25 top
+ *  radius, base at y = 0 - the same dimensions the
+ *  instanced path generates.
+ ***********************************************************/
+void MeshLibrary::GenerateTaperedCylinder(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int lodLevel)
+{
+	switch (lodLevel)
+	{
+	case 0: AppendMesh(g_TaperedCylinderMesh0, vertexData, indexData); break;
+	case 1: AppendMesh(g_TaperedCylinderMesh1, vertexData, indexData); break;
+	default: AppendMesh(g_TaperedCylinderMesh2, vertexData, indexData); break;
+	}
+}
+
+/***********************************************************
+ *  GenerateCylinder()
+ *
+ *  This method copies the compile-time tessellated cylinder
+ *  - a radius of one, one unit tall, base at y = 0.
+ ***********************************************************/
+void MeshLibrary::GenerateCylinder(
+	std::vector<float>& vertexData,
+	std::vector<unsigned int>& indexData,
+	int lodLevel)
+{
+	switch (lodLevel)
+	{
+	case 0: AppendMesh(g_CylinderMesh0, vertexData, indexData); break;
+	case 1: AppendMesh(g_CylinderMesh1, vertexData, indexData); break;
+	default: AppendMesh(g_CylinderMesh2, vertexData, indexData); break;
+	}
+}
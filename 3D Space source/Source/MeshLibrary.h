@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.h
+// ============
+// consolidated storage for all of the basic 3D shapes - every primitive
+// is packed into one interleaved vertex buffer and one index buffer
+// sharing a single vertex array, and each shape is drawn with a
+// glDrawElementsBaseVertex into the shared buffers so drawing a
+// different shape never rebinds a vertex array
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class MeshLibrary
+{
+public:
+	// the basic shapes stored in the shared buffers
+	enum MESH_ID
+	{
+		MESH_ID_PLANE,
+		MESH_ID_BOX,
+		MESH_ID_CONE,
+		MESH_ID_PRISM,
+		MESH_ID_PYRAMID3,
+		MESH_ID_SPHERE,
+		MESH_ID_TORUS,
+		MESH_ID_TAPERED_CYLINDER,
+		MESH_ID_CYLINDER,
+		MESH_ID_COUNT
+	};
+
+	// number of tessellation levels generated for the curved
+	// shapes - level 0 is full detail, higher levels drop
+	// segments for shapes covering only a few pixels; the flat
+	// shapes alias all levels to the same range
+	static const int LOD_LEVEL_COUNT = 3;
+
+	// constructor
+	MeshLibrary();
+	// destructor
+	~MeshLibrary();
+
+	// generate every basic shape and upload the packed vertex
+	// and index data into the shared GPU buffers
+	void LoadMeshes();
+
+	// bind/unbind the shared vertex array - done once around a
+	// run of DrawMesh() calls instead of once per draw
+	void BindMeshes();
+	void UnbindMeshes();
+
+	// draw one shape out of the shared buffers at the passed
+	// in detail level - the shared vertex array must be bound
+	void DrawMesh(MESH_ID meshID, int lodLevel = 0);
+
+	// look up where one shape's detail level lives inside the
+	// shared buffers - used by the indirect submission path to
+	// build its draw commands against the shared vertex array
+	void GetMeshRange(
+		MESH_ID meshID,
+		int lodLevel,
+		GLsizei& indexCount,
+		size_t& firstIndexByteOffset,
+		GLint& baseVertex) const;
+
+private:
+	// where one shape lives inside the shared buffers
+	struct MESH_RANGE
+	{
+		GLsizei indexCount = 0;
+		size_t firstIndexByteOffset = 0;
+		GLint baseVertex = 0;
+	};
+
+	// the generators append one shape's interleaved vertex
+	// data (position, normal, texture coordinate) and local
+	// index data at the requested detail level - the curved
+	// shapes only copy tables tessellated at compile time,
+	// and the flat shapes ignore the level
+	static void GeneratePlane(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GenerateBox(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GenerateCone(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GeneratePrism(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GeneratePyramid3(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GenerateSphere(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GenerateTorus(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GenerateTaperedCylinder(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+	static void GenerateCylinder(std::vector<float>& vertexData, std::vector<unsigned int>& indexData, int lodLevel);
+
+	// the shared GPU objects
+	GLuint m_vertexArray = 0;
+	GLuint m_vertexBuffer = 0;
+	GLuint m_indexBuffer = 0;
+
+	// where each shape's detail levels live inside the shared
+	// buffers - the flat shapes alias every level to level 0
+	MESH_RANGE m_meshRanges[MESH_ID_COUNT][LOD_LEVEL_COUNT];
+};
@@ -0,0 +1,343 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// skips draws hidden behind large occluders using hardware occlusion
+// queries - after the scene is drawn, the bounding box of every visible
+// node is rasterized against the depth buffer with writes masked off and
+// a GL_ANY_SAMPLES_PASSED query per box; the results are collected a
+// frame later without stalling, and nodes whose last known result was
+// fully occluded are skipped until a query sees them again
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include "ShaderCompiler.h"
+
+#include <iostream>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// declaration of global variables and defines
+namespace
+{
+	// vertex shader for the proxy boxes - position only, the
+	// camera comes from the shared uniform block every path
+	// binds at slot zero
+	const char* g_ProxyVertexShaderSource = R"(
+#version 440 core
+layout (location = 0) in vec3 inVertexPosition;
+
+layout(std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+uniform mat4 model;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(inVertexPosition, 1.0);
+}
+)";
+
+	// fragment shader for the proxy boxes - the output is
+	// masked off, only the samples-passed count matters
+	const char* g_ProxyFragmentShaderSource = R"(
+#version 440 core
+out vec4 outFragmentColor;
+
+void main()
+{
+	outFragmentColor = vec4(1.0);
+}
+)";
+
+	// the unit cube the proxy boxes are scaled from - corners
+	// at +-1 so a scale by the bounding radius encloses the
+	// node's bounding sphere
+	const float g_CubeVertices[] =
+	{
+		-1.0f, -1.0f, -1.0f,
+		 1.0f, -1.0f, -1.0f,
+		 1.0f,  1.0f, -1.0f,
+		-1.0f,  1.0f, -1.0f,
+		-1.0f, -1.0f,  1.0f,
+		 1.0f, -1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,
+		-1.0f,  1.0f,  1.0f,
+	};
+
+	const unsigned int g_CubeIndices[] =
+	{
+		0, 1, 2,  2, 3, 0,	// back
+		4, 6, 5,  6, 4, 7,	// front
+		0, 3, 7,  7, 4, 0,	// left
+		1, 5, 6,  6, 2, 1,	// right
+		3, 2, 6,  6, 7, 3,	// top
+		0, 4, 5,  5, 1, 0,	// bottom
+	};
+	const int g_CubeIndexCount =
+		(int)(sizeof(g_CubeIndices) / sizeof(g_CubeIndices[0]));
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller()
+{
+	m_bEnabled = false;
+	m_proxyProgram = 0;
+	m_modelLocation = -1;
+	m_cubeVertexArray = 0;
+	m_cubeVertexBuffer = 0;
+	m_cubeIndexBuffer = 0;
+	m_previousProgram = 0;
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+	for (size_t node = 0; node < m_nodeQueries.size(); node++)
+	{
+		if (m_nodeQueries[node].queryID != 0)
+		{
+			glDeleteQueries(1, &m_nodeQueries[node].queryID);
+		}
+	}
+	if (m_cubeIndexBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_cubeIndexBuffer);
+	}
+	if (m_cubeVertexBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_cubeVertexBuffer);
+	}
+	if (m_cubeVertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_cubeVertexArray);
+	}
+	if (m_proxyProgram != 0)
+	{
+		glDeleteProgram(m_proxyProgram);
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method builds the proxy cube mesh and the depth-only
+ *  program the bounding boxes are rasterized with.
+ ***********************************************************/
+bool OcclusionCuller::Create()
+{
+	m_proxyProgram = ShaderCompiler::CompileProgram(
+		g_ProxyVertexShaderSource,
+		g_ProxyFragmentShaderSource);
+	if (m_proxyProgram == 0)
+	{
+		std::cout << "WARNING: Occlusion culling disabled - proxy "
+			<< "program failed to compile" << std::endl;
+		return(false);
+	}
+	m_modelLocation = glGetUniformLocation(m_proxyProgram, "model");
+
+	glGenVertexArrays(1, &m_cubeVertexArray);
+	glBindVertexArray(m_cubeVertexArray);
+
+	glGenBuffers(1, &m_cubeVertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_cubeVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(g_CubeVertices),
+		g_CubeVertices, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_cubeIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_cubeIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(g_CubeIndices),
+		g_CubeIndices, GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+		3 * sizeof(float), (void*)0);
+
+	glBindVertexArray(0);
+
+	m_bEnabled = true;
+	std::cout << "INFO: Hardware occlusion culling active" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method sizes the per-node query state - new nodes
+ *  start visible so nothing pops in late.
+ ***********************************************************/
+void OcclusionCuller::Resize(int nodeCount)
+{
+	if ((m_bEnabled == false) || ((int)m_nodeQueries.size() >= nodeCount))
+	{
+		return;
+	}
+
+	size_t firstNewNode = m_nodeQueries.size();
+	m_nodeQueries.resize(nodeCount);
+	for (size_t node = firstNewNode; node < m_nodeQueries.size(); node++)
+	{
+		glGenQueries(1, &m_nodeQueries[node].queryID);
+	}
+}
+
+/***********************************************************
+ *  CollectResults()
+ *
+ *  This method collects any finished query results without
+ *  waiting - a query still in flight keeps its node's
+ *  previous answer, which hides the round-trip latency.
+ ***********************************************************/
+void OcclusionCuller::CollectResults()
+{
+	if (m_bEnabled == false)
+	{
+		return;
+	}
+
+	for (size_t node = 0; node < m_nodeQueries.size(); node++)
+	{
+		NODE_QUERY& nodeQuery = m_nodeQueries[node];
+		if (nodeQuery.bQueryInFlight == false)
+		{
+			continue;
+		}
+
+		GLuint resultAvailable = GL_FALSE;
+		glGetQueryObjectuiv(nodeQuery.queryID,
+			GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+		if (resultAvailable == GL_FALSE)
+		{
+			continue;
+		}
+
+		GLuint samplesPassed = GL_TRUE;
+		glGetQueryObjectuiv(nodeQuery.queryID,
+			GL_QUERY_RESULT, &samplesPassed);
+		nodeQuery.bOccluded = (samplesPassed == GL_FALSE);
+		nodeQuery.bQueryInFlight = false;
+	}
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method returns the frame-coherent answer for a node
+ *  - true only when its most recent completed query saw no
+ *  samples pass.
+ ***********************************************************/
+bool OcclusionCuller::IsOccluded(int nodeIndex) const
+{
+	if ((m_bEnabled == false) ||
+		(nodeIndex < 0) || (nodeIndex >= (int)m_nodeQueries.size()))
+	{
+		return(false);
+	}
+
+	return(m_nodeQueries[nodeIndex].bOccluded);
+}
+
+/***********************************************************
+ *  BeginProxyPass()
+ *
+ *  This method starts the proxy pass - the boxes only probe
+ *  the depth buffer, so color and depth writes are masked
+ *  off for the whole pass.
+ ***********************************************************/
+void OcclusionCuller::BeginProxyPass()
+{
+	if (m_bEnabled == false)
+	{
+		return;
+	}
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+
+	glGetIntegerv(GL_CURRENT_PROGRAM, &m_previousProgram);
+	glUseProgram(m_proxyProgram);
+	glBindVertexArray(m_cubeVertexArray);
+}
+
+/***********************************************************
+ *  EndProxyPass()
+ *
+ *  This method ends the proxy pass and restores the write
+ *  masks for the next frame's clears and draws.
+ ***********************************************************/
+void OcclusionCuller::EndProxyPass()
+{
+	if (m_bEnabled == false)
+	{
+		return;
+	}
+
+	glBindVertexArray(0);
+	glUseProgram((GLuint)m_previousProgram);
+
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+/***********************************************************
+ *  TestNode()
+ *
+ *  This method rasterizes the node's bounding box inside an
+ *  occlusion query - skipped when the node's previous query
+ *  has not completed yet, so a query is never overwritten.
+ ***********************************************************/
+void OcclusionCuller::TestNode(
+	int nodeIndex,
+	glm::vec3 boundingCenter,
+	float boundingRadius,
+	glm::vec3 viewPosition)
+{
+	if ((m_bEnabled == false) ||
+		(nodeIndex < 0) || (nodeIndex >= (int)m_nodeQueries.size()))
+	{
+		return;
+	}
+
+	NODE_QUERY& nodeQuery = m_nodeQueries[nodeIndex];
+
+	// a box containing the camera would be clipped by the near
+	// plane and read back as occluded - pin it visible instead
+	glm::vec3 toCenter = boundingCenter - viewPosition;
+	if (glm::dot(toCenter, toCenter) <
+		(boundingRadius * boundingRadius * 4.0f))
+	{
+		nodeQuery.bOccluded = false;
+		return;
+	}
+
+	if (nodeQuery.bQueryInFlight == true)
+	{
+		return;
+	}
+
+	// the cube spans +-1, so scaling by the radius encloses
+	// the node's bounding sphere
+	glm::mat4 model =
+		glm::translate(boundingCenter) * glm::scale(glm::vec3(boundingRadius));
+	glUniformMatrix4fv(m_modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, nodeQuery.queryID);
+	glDrawElements(GL_TRIANGLES, g_CubeIndexCount, GL_UNSIGNED_INT, (void*)0);
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+	nodeQuery.bQueryInFlight = true;
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// skips draws hidden behind large occluders using hardware occlusion
+// queries - after the scene is drawn, the bounding box of every visible
+// node is rasterized against the depth buffer with writes masked off and
+// a GL_ANY_SAMPLES_PASSED query per box; the results are collected a
+// frame later without stalling, and nodes whose last known result was
+// fully occluded are skipped until a query sees them again
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	// build the proxy cube mesh and its depth-only program -
+	// returns false when the program does not compile, which
+	// leaves the culler disabled and every node visible
+	bool Create();
+
+	// true once Create() succeeded
+	bool IsEnabled() const { return(m_bEnabled); }
+
+	// size the per-node query state - call whenever nodes are
+	// added to the scene; new nodes start visible
+	void Resize(int nodeCount);
+
+	// collect any finished query results - call once per frame
+	// before the visibility decisions; queries that have not
+	// completed keep their node's previous result, so nothing
+	// ever waits on the GPU
+	void CollectResults();
+
+	// the frame-coherent answer for a node - true only when the
+	// node's most recent completed query saw no samples pass
+	bool IsOccluded(int nodeIndex) const;
+
+	// bracket the proxy pass - masks off color and depth writes
+	// and binds the cube mesh and the depth-only program
+	void BeginProxyPass();
+	void EndProxyPass();
+
+	// rasterize the node's bounding box inside a query - call
+	// between Begin/EndProxyPass for every in-frustum node so a
+	// skipped node is still re-tested and can reappear; a node
+	// whose box contains the camera is pinned visible, since
+	// its proxy would be clipped by the near plane
+	void TestNode(
+		int nodeIndex,
+		glm::vec3 boundingCenter,
+		float boundingRadius,
+		glm::vec3 viewPosition);
+
+private:
+	// true once Create() succeeded
+	bool m_bEnabled;
+
+	// the depth-only program the proxies are drawn with and the
+	// location of its model matrix uniform
+	GLuint m_proxyProgram;
+	GLint m_modelLocation;
+
+	// the unit cube the proxy boxes are scaled from
+	GLuint m_cubeVertexArray;
+	GLuint m_cubeVertexBuffer;
+	GLuint m_cubeIndexBuffer;
+
+	// the program bound before the proxy pass, restored after
+	GLint m_previousProgram;
+
+	// the per-node query state
+	struct NODE_QUERY
+	{
+		GLuint queryID = 0;
+		bool bQueryInFlight = false;
+		bool bOccluded = false;
+	};
+	std::vector<NODE_QUERY> m_nodeQueries;
+};
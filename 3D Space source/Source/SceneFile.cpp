@@ -0,0 +1,401 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// loads scene descriptions - object placements with their transforms and
+// material/texture tags - from a text file, and keeps a compiled binary
+// cache beside it so later startups load the whole scene with a single
+// read instead of parsing text per object
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include "AssetPack.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// declaration of global variables and defines
+namespace
+{
+	// identifies the compiled cache format - bumped whenever the
+	// record layout changes so stale caches are rebuilt instead
+	// of misread
+	const uint32_t g_CacheMagic = 0x424E4353; // 'SCNB'
+	const uint32_t g_CacheVersion = 1;
+
+	// the cache file starts with this fixed header, followed by
+	// recordCount tightly packed records
+	struct CACHE_HEADER
+	{
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t recordSize = 0;
+		uint32_t recordCount = 0;
+	};
+
+	// mesh shape names accepted by the text format - the order
+	// must exactly mirror the MESH_SHAPE enumeration in
+	// SceneManager.h, the stored value is the enum cast
+	const char* const g_MeshShapeNames[] =
+	{
+		"plane",
+		"box",
+		"cone",
+		"prism",
+		"pyramid3",
+		"sphere",
+		"torus",
+		"tapered_cylinder",
+		"cylinder",
+	};
+	const int g_MeshShapeNameCount =
+		(int)(sizeof(g_MeshShapeNames) / sizeof(g_MeshShapeNames[0]));
+
+	// copy a tag string into a fixed-size record field, always
+	// leaving the field zero terminated
+	void CopyTag(char (&destination)[SceneFile::MAX_TAG_LENGTH], const std::string& tag)
+	{
+#if defined(_MSC_VER)
+		strncpy_s(destination, tag.c_str(), SceneFile::MAX_TAG_LENGTH - 1);
+#else
+		strncpy(destination, tag.c_str(), SceneFile::MAX_TAG_LENGTH - 1);
+		destination[SceneFile::MAX_TAG_LENGTH - 1] = '\0';
+#endif
+	}
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method loads the scene records - the binary cache
+ *  is read when it is present and not older than the text
+ *  file, otherwise the text file is parsed once and the
+ *  cache is rewritten for the next startup.
+ ***********************************************************/
+bool SceneFile::Load(
+	const char* textFilename,
+	const char* cacheFilename,
+	std::vector<SCENE_FILE_RECORD>& records)
+{
+	records.clear();
+
+	long long textTime = GetFileModifiedTime(textFilename);
+	long long cacheTime = GetFileModifiedTime(cacheFilename);
+
+	// the cache is usable when it exists and the text file has
+	// not been edited since it was compiled
+	if ((cacheTime >= 0) && ((textTime < 0) || (cacheTime >= textTime)))
+	{
+		if (ReadCache(cacheFilename, records) == true)
+		{
+			return(true);
+		}
+	}
+
+	if (ParseText(textFilename, records) == false)
+	{
+		return(false);
+	}
+
+	// compile the parsed records so the next startup skips the
+	// text parse entirely
+	WriteCache(cacheFilename, records);
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadCache()
+ *
+ *  This method reads the compiled cache - one header check
+ *  and one read for the whole record array.
+ ***********************************************************/
+bool SceneFile::ReadCache(
+	const char* cacheFilename,
+	std::vector<SCENE_FILE_RECORD>& records)
+{
+	FILE* pFile = NULL;
+#if defined(_MSC_VER)
+	fopen_s(&pFile, cacheFilename, "rb");
+#else
+	pFile = fopen(cacheFilename, "rb");
+#endif
+	if (NULL == pFile)
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	if (fread(&header, sizeof(header), 1, pFile) != 1)
+	{
+		fclose(pFile);
+		return(false);
+	}
+
+	// reject caches from a different format revision or record
+	// layout - the caller falls back to the text parse
+	if ((header.magic != g_CacheMagic) ||
+		(header.version != g_CacheVersion) ||
+		(header.recordSize != (uint32_t)sizeof(SCENE_FILE_RECORD)))
+	{
+		fclose(pFile);
+		return(false);
+	}
+
+	// the records are flat and tightly packed, so the whole
+	// scene loads with this single read
+	records.resize(header.recordCount);
+	size_t recordsRead = 0;
+	if (header.recordCount > 0)
+	{
+		recordsRead = fread(
+			records.data(),
+			sizeof(SCENE_FILE_RECORD),
+			header.recordCount,
+			pFile);
+	}
+	fclose(pFile);
+
+	if (recordsRead != (size_t)header.recordCount)
+	{
+		records.clear();
+		return(false);
+	}
+
+	std::cout << "INFO: Loaded " << records.size()
+		<< " scene objects from cache " << cacheFilename << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method writes the record array back out as the
+ *  compiled cache for the next startup.
+ ***********************************************************/
+void SceneFile::WriteCache(
+	const char* cacheFilename,
+	const std::vector<SCENE_FILE_RECORD>& records)
+{
+	FILE* pFile = NULL;
+#if defined(_MSC_VER)
+	fopen_s(&pFile, cacheFilename, "wb");
+#else
+	pFile = fopen(cacheFilename, "wb");
+#endif
+	if (NULL == pFile)
+	{
+		std::cout << "WARNING: Could not write scene cache "
+			<< cacheFilename << std::endl;
+		return;
+	}
+
+	CACHE_HEADER header;
+	header.magic = g_CacheMagic;
+	header.version = g_CacheVersion;
+	header.recordSize = (uint32_t)sizeof(SCENE_FILE_RECORD);
+	header.recordCount = (uint32_t)records.size();
+
+	fwrite(&header, sizeof(header), 1, pFile);
+	if (records.empty() == false)
+	{
+		fwrite(records.data(), sizeof(SCENE_FILE_RECORD), records.size(), pFile);
+	}
+	fclose(pFile);
+
+	std::cout << "INFO: Compiled " << records.size()
+		<< " scene objects into cache " << cacheFilename << std::endl;
+}
+
+/***********************************************************
+ *  ParseText()
+ *
+ *  This method parses the text scene description - the loose
+ *  file is opened when it exists, otherwise the copy bundled
+ *  in the asset pack is parsed in place.
+ ***********************************************************/
+bool SceneFile::ParseText(
+	const char* textFilename,
+	std::vector<SCENE_FILE_RECORD>& records)
+{
+	std::ifstream fileStream(textFilename);
+	if (fileStream.is_open() == true)
+	{
+		return(ParseStream(textFilename, fileStream, records));
+	}
+
+	// no loose file - fall back to the copy bundled in the
+	// asset pack
+	const unsigned char* packData = NULL;
+	size_t packSize = 0;
+	if (AssetPack::Instance().GetAsset(textFilename, packData, packSize) == true)
+	{
+		std::istringstream packStream(
+			std::string((const char*)packData, packSize));
+		return(ParseStream(textFilename, packStream, records));
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  ParseStream()
+ *
+ *  This method parses the text scene description from an
+ *  already opened stream - each "object <shape>" line starts
+ *  a record and the property lines after it fill the record
+ *  in, until the next object line or the end of the stream.
+ ***********************************************************/
+bool SceneFile::ParseStream(
+	const char* textFilename,
+	std::istream& sceneStream,
+	std::vector<SCENE_FILE_RECORD>& records)
+{
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(sceneStream, line))
+	{
+		lineNumber++;
+
+		std::istringstream lineStream(line);
+		std::string keyword;
+		if (!(lineStream >> keyword))
+		{
+			continue;
+		}
+		// '#' starts a comment line
+		if (keyword[0] == '#')
+		{
+			continue;
+		}
+
+		if (keyword == "object")
+		{
+			std::string shapeName;
+			lineStream >> shapeName;
+
+			int meshShape = FindMeshShape(shapeName.c_str());
+			if (meshShape < 0)
+			{
+				std::cout << "WARNING: " << textFilename << "(" << lineNumber
+					<< "): unknown mesh shape '" << shapeName << "'" << std::endl;
+				continue;
+			}
+
+			SCENE_FILE_RECORD record;
+			record.meshShape = meshShape;
+			records.push_back(record);
+			continue;
+		}
+
+		// every other keyword is a property of the current object
+		if (records.empty() == true)
+		{
+			std::cout << "WARNING: " << textFilename << "(" << lineNumber
+				<< "): property before any object line" << std::endl;
+			continue;
+		}
+
+		SCENE_FILE_RECORD& record = records.back();
+
+		if (keyword == "scale")
+		{
+			lineStream >> record.scaleXYZ[0]
+				>> record.scaleXYZ[1]
+				>> record.scaleXYZ[2];
+		}
+		else if (keyword == "rotate")
+		{
+			lineStream >> record.rotationDegreesXYZ[0]
+				>> record.rotationDegreesXYZ[1]
+				>> record.rotationDegreesXYZ[2];
+		}
+		else if (keyword == "position")
+		{
+			lineStream >> record.positionXYZ[0]
+				>> record.positionXYZ[1]
+				>> record.positionXYZ[2];
+		}
+		else if (keyword == "uv")
+		{
+			lineStream >> record.uvScale[0] >> record.uvScale[1];
+		}
+		else if (keyword == "color")
+		{
+			lineStream >> record.color[0] >> record.color[1]
+				>> record.color[2] >> record.color[3];
+		}
+		else if (keyword == "texture")
+		{
+			std::string tag;
+			lineStream >> tag;
+			CopyTag(record.textureTag, tag);
+		}
+		else if (keyword == "material")
+		{
+			std::string tag;
+			lineStream >> tag;
+			CopyTag(record.materialTag, tag);
+		}
+		else
+		{
+			std::cout << "WARNING: " << textFilename << "(" << lineNumber
+				<< "): unknown keyword '" << keyword << "'" << std::endl;
+		}
+	}
+
+	std::cout << "INFO: Parsed " << records.size()
+		<< " scene objects from " << textFilename << std::endl;
+
+	return(records.empty() == false);
+}
+
+/***********************************************************
+ *  GetFileModifiedTime()
+ *
+ *  This method returns the modification time of a file, or
+ *  -1 when the file does not exist.
+ ***********************************************************/
+long long SceneFile::GetFileModifiedTime(const char* filename)
+{
+#if defined(_MSC_VER)
+	struct _stat64 fileStatus;
+	if (_stat64(filename, &fileStatus) != 0)
+	{
+		return(-1);
+	}
+#else
+	struct stat fileStatus;
+	if (stat(filename, &fileStatus) != 0)
+	{
+		return(-1);
+	}
+#endif
+	return((long long)fileStatus.st_mtime);
+}
+
+/***********************************************************
+ *  FindMeshShape()
+ *
+ *  This method maps a mesh shape name from the text file
+ *  onto the shape enumeration.
+ ***********************************************************/
+int SceneFile::FindMeshShape(const char* shapeName)
+{
+	for (int index = 0; index < g_MeshShapeNameCount; index++)
+	{
+		if (strcmp(shapeName, g_MeshShapeNames[index]) == 0)
+		{
+			return(index);
+		}
+	}
+	return(-1);
+}
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// loads scene descriptions - object placements with their transforms and
+// material/texture tags - from a text file, and keeps a compiled binary
+// cache beside it so later startups load the whole scene with a single
+// read instead of parsing text per object
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+class SceneFile
+{
+public:
+	// the maximum length of a texture or material tag stored in
+	// a record, including the terminating zero
+	static const int MAX_TAG_LENGTH = 24;
+
+	// one object placement - a flat fixed-size record with no
+	// pointers or variable-length fields, so the binary cache is
+	// just the header followed by an array of these and could be
+	// memory mapped directly
+	struct SCENE_FILE_RECORD
+	{
+		int32_t meshShape = 0;
+		float scaleXYZ[3] = { 1.0f, 1.0f, 1.0f };
+		float rotationDegreesXYZ[3] = { 0.0f, 0.0f, 0.0f };
+		float positionXYZ[3] = { 0.0f, 0.0f, 0.0f };
+		float uvScale[2] = { 1.0f, 1.0f };
+		float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		char textureTag[MAX_TAG_LENGTH] = { 0 };
+		char materialTag[MAX_TAG_LENGTH] = { 0 };
+	};
+
+	// load the scene records - reads the binary cache when it is
+	// present and not older than the text file, otherwise parses
+	// the text file and rewrites the cache; returns false when
+	// neither file could be loaded
+	static bool Load(
+		const char* textFilename,
+		const char* cacheFilename,
+		std::vector<SCENE_FILE_RECORD>& records);
+
+private:
+	// read the compiled cache - one header check and one read
+	// for the whole record array, no per-object work
+	static bool ReadCache(
+		const char* cacheFilename,
+		std::vector<SCENE_FILE_RECORD>& records);
+
+	// write the record array back out as the compiled cache
+	static void WriteCache(
+		const char* cacheFilename,
+		const std::vector<SCENE_FILE_RECORD>& records);
+
+	// parse the text scene description into records - opens the
+	// loose file when it exists, otherwise the copy bundled in
+	// the asset pack
+	static bool ParseText(
+		const char* textFilename,
+		std::vector<SCENE_FILE_RECORD>& records);
+
+	// parse the text scene description from an already opened
+	// stream - the filename is only used for warnings
+	static bool ParseStream(
+		const char* textFilename,
+		std::istream& sceneStream,
+		std::vector<SCENE_FILE_RECORD>& records);
+
+	// modification time of a file, or -1 when it does not exist
+	static long long GetFileModifiedTime(const char* filename);
+
+	// map a mesh shape name from the text file onto the shape
+	// enumeration, returning -1 for an unknown name
+	static int FindMeshShape(const char* shapeName);
+};
@@ -1,611 +1,2288 @@
-///////////////////////////////////////////////////////////////////////////////
-// shadermanager.cpp
-// ============
-// manage the loading and rendering of 3D scenes
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-#include "ViewManager.h"
-
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-/**************************************************************/
-/* Setting up the lighting */
-void SceneManager::SetupSceneLights()
-{
-	if (m_pShaderManager != nullptr)
-	{
-		m_pShaderManager->setVec3Value("dirLight.direction", glm::vec3(-0.5f, -0.8f, 0.8f));
-		m_pShaderManager->setVec3Value("dirLight.ambient", glm::vec3(0.3f, 0.3f, 0.3f));
-		m_pShaderManager->setVec3Value("dirLight.diffuse", glm::vec3(0.7f, 0.7f, 0.7f));
-
-		m_pShaderManager->setVec3Value("spotLight.position", glm::vec3(5.5f, 4.0f, 0.5f));
-		m_pShaderManager->setVec3Value("spotLight.direction", glm::vec3(-0.8f, -1.0f, -0.2f));
-
-		m_pShaderManager->setVec3Value("spotLight.ambient", glm::vec3(0.1f, 0.1f, 0.1f));
-		m_pShaderManager->setVec3Value("spotLight.diffuse", glm::vec3(1.0f, 0.95f, 0.8f)); // Warm bulb color
-		m_pShaderManager->setVec3Value("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-		m_pShaderManager->setFloatValue("spotLight.constant", 1.0f);
-		m_pShaderManager->setFloatValue("spotLight.linear", 0.045f);
-		m_pShaderManager->setFloatValue("spotLight.quadratic", 0.0075f);
-
-		m_pShaderManager->setFloatValue("spotLight.cutOff", glm::cos(glm::radians(15.0f)));
-		m_pShaderManager->setFloatValue("spotLight.outerCutOff", glm::cos(glm::radians(25.0f)));
-	}
-}
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	LoadSceneTextures();
-	LoadSceneMaterials();
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadPrismMesh();
-	m_basicMeshes->LoadPyramid3Mesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadCylinderMesh();
-}
-void SceneManager::LoadSceneMaterials()
-{
-
-	OBJECT_MATERIAL marble;
-	marble.tag = "marble";
-	marble.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f); 
-	marble.ambientStrength = 0.4f;
-	marble.diffuseColor = glm::vec3(0.9f, 0.9f, 0.9f); 
-	marble.specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
-	marble.shininess = 16.0f;
-	m_objectMaterials.push_back(marble);
-
-	OBJECT_MATERIAL gold;
-	gold.tag = "gold";
-	gold.ambientColor = glm::vec3(0.25f, 0.20f, 0.07f);
-	gold.ambientStrength = 0.3f;
-	gold.diffuseColor = glm::vec3(0.8f, 0.65f, 0.25f);  
-	gold.specularColor = glm::vec3(0.65f, 0.55f, 0.35f);
-	gold.shininess = 51.2f;
-	m_objectMaterials.push_back(gold);
-
-	OBJECT_MATERIAL granite;
-	granite.tag = "granite";
-	granite.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	granite.ambientStrength = 0.35f;
-	granite.diffuseColor = glm::vec3(0.6f, 0.6f, 0.6f);
-	granite.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
-	granite.shininess = 8.0f;
-	m_objectMaterials.push_back(granite);
-
-	OBJECT_MATERIAL wall;
-	wall.tag = "wall";
-	wall.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	wall.ambientStrength = 0.5f;
-	wall.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	wall.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
-	wall.shininess = 1.0f;
-	m_objectMaterials.push_back(wall);
-
-	OBJECT_MATERIAL lamp;
-	lamp.tag = "lamp";
-	lamp.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	lamp.ambientStrength = 0.5f;
-	lamp.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	lamp.specularColor = glm::vec3(0.2f, 0.2f, 0.2f); // Low shine
-	lamp.shininess = 2.0f;
-	m_objectMaterials.push_back(lamp);
-}
-/**************************************************************/
-/* LoadingScreenTexture() */
-void SceneManager::LoadSceneTextures() {
-	bool bReturn = false;
-	bReturn = CreateGLTexture(
-		"textures/wood.jpg", "wood");
-	bReturn = CreateGLTexture(
-		"textures/wall.jpg", "wall");
-	bReturn = CreateGLTexture(
-		"textures/pot.jpg", "pot");
-	bReturn = CreateGLTexture(
-		"textures/leaf.jpg", "leaf");
-	bReturn = CreateGLTexture(
-		"textures/lamp.jpg", "lamp");
-	bReturn = CreateGLTexture(
-		"textures/marble.jpg", "marble");
-	bReturn = CreateGLTexture(
-		"textures/granite.jpg", "granite");
-	bReturn = CreateGLTexture(
-		"textures/gold.jpg", "gold");
-	BindGLTextures();
-}
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	SetupSceneLights();
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-
-		// The back wall
-		scaleXYZ = glm::vec3(40.0f, 1.0f, 40.0f);
-		positionXYZ = glm::vec3(0.0f, 4.0f, -10.0f);
-		SetTransformations(scaleXYZ, -90.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderTexture("wall");
-		m_pShaderManager->setIntValue("bUseTexture", true);
-		SetTextureUVScale(1.0f, 1.0f);
-		SetShaderMaterial("wall");
-		m_basicMeshes->DrawPlaneMesh();
-
-		// Desk Surface
-		SetTransformations(glm::vec3(20.0f, 1.0f, 20.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, -0.5f, 0.0f));
-		SetShaderMaterial("wall"); //
-		SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-		m_basicMeshes->DrawPlaneMesh();
-
-		// Lamp base
-		scaleXYZ = glm::vec3(1.5f, 0.2f, 1.5f);
-		positionXYZ = glm::vec3(5.0f, 0.0f, 0.0f); // Base position
-		SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderMaterial("granite"); // Using granite so it's not invisible white
-		SetShaderColor(0.85f, 0.85f, 0.85f, 1.0f);
-		m_basicMeshes->DrawCylinderMesh();
-
-		//Lamp Neck
-		scaleXYZ = glm::vec3(0.05f, 4.0f, 0.05f);
-		positionXYZ = glm::vec3(6.0f, 0.0f, 0.0f);
-		SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderMaterial("lamp");
-		m_basicMeshes->DrawCylinderMesh();
-
-		// Lamp Shade
-		scaleXYZ = glm::vec3(1.2f, 1.5f, 1.2f);
-		positionXYZ = glm::vec3(5.5f, 3.8f, 0.0f);
-		SetTransformations(scaleXYZ, -45.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderMaterial("lamp");
-		m_basicMeshes->DrawTaperedCylinderMesh();
-
-		// Lamp Bulb
-		scaleXYZ = glm::vec3(0.2f, 0.2f, 0.2f);
-		positionXYZ = glm::vec3(5.5f, 3.6f, 0.0f);
-		SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderColor(1.0f, 1.0f, 0.0f, 1.0f); // Bright Yellow
-		m_pShaderManager->setIntValue("bUseTexture", false);
-		m_basicMeshes->DrawSphereMesh();
-
-		//Lamp Joint
-		scaleXYZ = glm::vec3(0.15f, 0.3f, 0.15f);
-		positionXYZ = glm::vec3(6.0f, 4.0f, -0.2f);
-		SetTransformations(scaleXYZ, 0.0f, 0.0f, 90.0f, positionXYZ);
-		SetShaderMaterial("gold"); //
-		m_basicMeshes->DrawCylinderMesh();
-
-		//Clock 
-		scaleXYZ = glm::vec3(1.6f, 0.05f, 1.6f);
-		positionXYZ = glm::vec3(-2.0f, 7.0f, -4.95f); 
-		SetTransformations(scaleXYZ, 90.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderMaterial("marble");
-		m_pShaderManager->setIntValue("bUseTexture", false);
-		SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-		m_basicMeshes->DrawCylinderMesh();
-		//Clock Face
-		scaleXYZ = glm::vec3(1.5f, 0.1f, 1.5f);
-		positionXYZ = glm::vec3(-2.0f, 7.0f, -4.9f); 
-		SetTransformations(scaleXYZ, 90.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderTexture("wood");
-		m_pShaderManager->setIntValue("bUseTexture", true);
-		m_basicMeshes->DrawCylinderMesh();
-
-		// Pot
-		scaleXYZ = glm::vec3(1.2f, 1.0f, 1.2f);
-		positionXYZ = glm::vec3(2.0f, 0.5f, 0.0f);
-		SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderMaterial("granite"); //
-		SetShaderColor(0.8f, 0.8f, 0.8f, 1.0f);
-		m_basicMeshes->DrawSphereMesh();
-
-		// Leaves
-		m_pShaderManager->setIntValue("bUseTexture", true);
-		SetShaderTexture("leaf");
-
-		int leafCount = 10;
-		for (int i = 0; i < leafCount; i++) {
-			float randomHeight = 1.5f + (static_cast<float>(i % 3) * 0.2f);
-			scaleXYZ = glm::vec3(0.12f, randomHeight, 0.4f);
-
-			positionXYZ = glm::vec3(2.0f, 1.3f, 0.0f);
-
-			float yRotation = i * (360.0f / leafCount);
-			float xTilt = 20.0f + (i * 3.0f);
-			float zLean = (i % 2 == 0) ? 5.0f : -5.0f;
-
-			SetTransformations(scaleXYZ, xTilt, yRotation, zLean, positionXYZ);
-			m_basicMeshes->DrawTaperedCylinderMesh();
-		}
-	}
\ No newline at end of file
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// manage the loading and rendering of 3D scenes
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <glm/gtx/transform.hpp>
+#include "ViewManager.h"
+#include "AssetPack.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "SceneFile.h"
+#include "ShaderVariants.h"
+#include "UniformBlocks.h"
+#include "UniformCache.h"
+
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureLayerName = "textureLayer";
+
+	// extract the six frustum planes from the combined
+	// view-projection matrix (Gribb-Hartmann), normalized so
+	// plane distances compare directly against sphere radii
+	void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			planes[axis * 2] = glm::vec4(
+				viewProjection[0][3] + viewProjection[0][axis],
+				viewProjection[1][3] + viewProjection[1][axis],
+				viewProjection[2][3] + viewProjection[2][axis],
+				viewProjection[3][3] + viewProjection[3][axis]);
+			planes[axis * 2 + 1] = glm::vec4(
+				viewProjection[0][3] - viewProjection[0][axis],
+				viewProjection[1][3] - viewProjection[1][axis],
+				viewProjection[2][3] - viewProjection[2][axis],
+				viewProjection[3][3] - viewProjection[3][axis]);
+		}
+
+		for (int plane = 0; plane < 6; plane++)
+		{
+			float length = glm::length(glm::vec3(planes[plane]));
+			if (length > 0.0f)
+			{
+				planes[plane] /= length;
+			}
+		}
+	}
+
+	// true when the bounding sphere is at least partially
+	// inside all six frustum planes
+	bool SphereInFrustum(const glm::vec4 planes[6], glm::vec3 center, float radius)
+	{
+		for (int plane = 0; plane < 6; plane++)
+		{
+			float distance =
+				planes[plane].x * center.x +
+				planes[plane].y * center.y +
+				planes[plane].z * center.z +
+				planes[plane].w;
+			if (distance < -radius)
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	// true when the bounding sphere is visible in at least one
+	// viewport's frustum - the shared traversal records the
+	// union of the per-viewport visible sets
+	bool SphereInAnyFrustum(
+		const glm::vec4 frustumPlanes[][6],
+		int viewportCount,
+		glm::vec3 center,
+		float radius)
+	{
+		for (int viewport = 0; viewport < viewportCount; viewport++)
+		{
+			if (SphereInFrustum(frustumPlanes[viewport], center, radius) == true)
+			{
+				return(true);
+			}
+		}
+
+		return(false);
+	}
+
+	// fraction of the viewport height a node's bounding sphere
+	// covers when it drops below these, the mesh library's
+	// reduced tessellations are drawn instead of full detail
+	const float g_LodScreenHeight[MeshLibrary::LOD_LEVEL_COUNT - 1] = { 0.25f, 0.08f };
+
+	/*******************************************************
+	 *  SelectLodLevel()
+	 *
+	 *  This function picks a detail level for a node from
+	 *  the screen-space height of its bounding sphere - a
+	 *  bulb covering a few pixels should not pay the vertex
+	 *  cost of the full tessellation.
+	 *******************************************************/
+	int SelectLodLevel(
+		glm::vec3 boundingCenter,
+		float boundingRadius,
+		glm::vec3 viewPosition,
+		float projectionScaleY)
+	{
+		float distance = glm::length(boundingCenter - viewPosition);
+		if (distance <= boundingRadius)
+		{
+			return(0);
+		}
+
+		// projected diameter as a fraction of the viewport
+		// height - projectionScaleY is the [1][1] term of the
+		// projection matrix (cot of half the field of view)
+		float screenHeight = (boundingRadius * projectionScaleY) / distance;
+
+		for (int lodLevel = 0; lodLevel < MeshLibrary::LOD_LEVEL_COUNT - 1; lodLevel++)
+		{
+			if (screenHeight > g_LodScreenHeight[lodLevel])
+			{
+				return(lodLevel);
+			}
+		}
+		return(MeshLibrary::LOD_LEVEL_COUNT - 1);
+	}
+
+	// true for the scene's major occluders - the wall and desk
+	// planes and anything comparably large; these are always
+	// drawn and never occlusion-tested, everything else is
+	// tested against the depth they leave behind
+	bool IsMajorOccluder(const SceneManager::SCENE_NODE& node)
+	{
+		return((node.meshShape == SceneManager::MESH_PLANE) ||
+			(node.boundingRadius >= 8.0f));
+	}
+
+	// one visible draw waiting to be ordered for its pass -
+	// the opaque pass buckets by shader permutation and sorts
+	// ascending on distance within each bucket so early-Z
+	// rejects hidden fill, the transparent pass sorts purely
+	// descending so the blend composes back to front
+	struct DRAW_ORDER
+	{
+		float distance = 0.0f;
+		int queueIndex = 0;
+		int variant = 0;
+	};
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager()
+{
+	m_meshLibrary = new MeshLibrary();
+	m_textureArray = new TextureArray();
+	m_instancedMeshes = new InstancedMeshes();
+	m_indirectRenderer = new IndirectRenderer();
+	m_occlusionCuller = new OcclusionCuller();
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	// make sure no texture decode is still running before the
+	// object goes away
+	for (size_t worker = 0; worker < m_textureWorkers.size(); worker++)
+	{
+		if (m_textureWorkers[worker].joinable())
+		{
+			m_textureWorkers[worker].join();
+		}
+	}
+	m_textureWorkers.clear();
+
+	delete m_meshLibrary;
+	m_meshLibrary = NULL;
+	delete m_textureArray;
+	m_textureArray = NULL;
+	delete m_instancedMeshes;
+	m_instancedMeshes = NULL;
+	delete m_indirectRenderer;
+	m_indirectRenderer = NULL;
+	delete m_occlusionCuller;
+	m_occlusionCuller = NULL;
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files
+ *  into the next layer of the shared texture array, which is
+ *  what every draw samples from.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// precompressed container formats skip the stb decode
+	if (IsDDSFile(filename))
+	{
+		return(LoadDDSTexture(filename, tag));
+	}
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	// try to parse the image data from the specified image file,
+	// decoding from the mapped archive slice when it is packed
+	unsigned char* image = NULL;
+	const unsigned char* packData = NULL;
+	size_t packSize = 0;
+	if (AssetPack::Instance().GetAsset(filename, packData, packSize))
+	{
+		image = stbi_load_from_memory(
+			packData,
+			(int)packSize,
+			&width,
+			&height,
+			&colorChannels,
+			0);
+	}
+	else
+	{
+		image = stbi_load(
+			filename,
+			&width,
+			&height,
+			&colorChannels,
+			0);
+	}
+
+	// if the image was successfully read from the image file
+	if (image)
+	{
+		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+
+		int layer = m_textureArray->AllocateLayer();
+		if (layer < 0)
+		{
+			stbi_image_free(image);
+			return false;
+		}
+
+		m_textureArray->UploadLayer(layer, image, width, height, colorChannels);
+
+		// free the image data from local memory
+		stbi_image_free(image);
+
+		// register the layer and associate it with the special tag string
+		m_textureSlotMap[HashTag(tag)] = layer;
+		MarkTextureAlpha(layer, (colorChannels == 4));
+
+		return true;
+	}
+
+	std::cout << "Could not load image:" << filename << std::endl;
+
+	// Error loading the image
+	return false;
+}
+
+// layout of the DDS file header, used by LoadDDSTexture()
+namespace
+{
+#pragma pack(push, 1)
+	struct DDS_PIXELFORMAT
+	{
+		uint32_t dwSize;
+		uint32_t dwFlags;
+		uint32_t dwFourCC;
+		uint32_t dwRGBBitCount;
+		uint32_t dwRBitMask;
+		uint32_t dwGBitMask;
+		uint32_t dwBBitMask;
+		uint32_t dwABitMask;
+	};
+
+	struct DDS_HEADER
+	{
+		uint32_t dwSize;
+		uint32_t dwFlags;
+		uint32_t dwHeight;
+		uint32_t dwWidth;
+		uint32_t dwPitchOrLinearSize;
+		uint32_t dwDepth;
+		uint32_t dwMipMapCount;
+		uint32_t dwReserved1[11];
+		DDS_PIXELFORMAT ddspf;
+		uint32_t dwCaps;
+		uint32_t dwCaps2;
+		uint32_t dwCaps3;
+		uint32_t dwCaps4;
+		uint32_t dwReserved2;
+	};
+
+	struct DDS_HEADER_DXT10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+#pragma pack(pop)
+
+	// build the little-endian fourCC code for comparisons
+	uint32_t MakeFourCC(char c0, char c1, char c2, char c3)
+	{
+		return((uint32_t)(unsigned char)c0 |
+			((uint32_t)(unsigned char)c1 << 8) |
+			((uint32_t)(unsigned char)c2 << 16) |
+			((uint32_t)(unsigned char)c3 << 24));
+	}
+
+	// the DXGI format codes the DX10 extension header can carry
+	const uint32_t DXGI_FORMAT_BC7_UNORM_CODE = 98;
+	const uint32_t DXGI_FORMAT_BC7_UNORM_SRGB_CODE = 99;
+
+	// the block compression variants the CPU unpacker handles
+	enum BC_VARIANT
+	{
+		BC_VARIANT_NONE,
+		BC_VARIANT_BC1,
+		BC_VARIANT_BC2,
+		BC_VARIANT_BC3
+	};
+
+	/*******************************************************
+	 *  DecodeColorBlock()
+	 *
+	 *  This function unpacks the 8-byte 565 color half of a
+	 *  block into 16 RGBA pixels - bAlphaBlock selects the
+	 *  4-color mode BC2/BC3 always use.
+	 *******************************************************/
+	void DecodeColorBlock(
+		const unsigned char* block,
+		bool bAlphaBlock,
+		unsigned char pixels[16][4])
+	{
+		uint16_t color0 = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t color1 = (uint16_t)(block[2] | (block[3] << 8));
+
+		unsigned char palette[4][4];
+		palette[0][0] = (unsigned char)(((color0 >> 11) & 31) * 255 / 31);
+		palette[0][1] = (unsigned char)(((color0 >> 5) & 63) * 255 / 63);
+		palette[0][2] = (unsigned char)((color0 & 31) * 255 / 31);
+		palette[0][3] = 255;
+		palette[1][0] = (unsigned char)(((color1 >> 11) & 31) * 255 / 31);
+		palette[1][1] = (unsigned char)(((color1 >> 5) & 63) * 255 / 63);
+		palette[1][2] = (unsigned char)((color1 & 31) * 255 / 31);
+		palette[1][3] = 255;
+
+		if ((color0 > color1) || (bAlphaBlock == true))
+		{
+			for (int channel = 0; channel < 3; channel++)
+			{
+				palette[2][channel] = (unsigned char)(
+					(2 * palette[0][channel] + palette[1][channel]) / 3);
+				palette[3][channel] = (unsigned char)(
+					(palette[0][channel] + 2 * palette[1][channel]) / 3);
+			}
+			palette[2][3] = 255;
+			palette[3][3] = 255;
+		}
+		else
+		{
+			// BC1 three-color mode - the fourth entry is
+			// punch-through transparent black
+			for (int channel = 0; channel < 3; channel++)
+			{
+				palette[2][channel] = (unsigned char)(
+					(palette[0][channel] + palette[1][channel]) / 2);
+				palette[3][channel] = 0;
+			}
+			palette[2][3] = 255;
+			palette[3][3] = 0;
+		}
+
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			int paletteIndex = (block[4 + pixel / 4] >> ((pixel % 4) * 2)) & 3;
+			pixels[pixel][0] = palette[paletteIndex][0];
+			pixels[pixel][1] = palette[paletteIndex][1];
+			pixels[pixel][2] = palette[paletteIndex][2];
+			pixels[pixel][3] = palette[paletteIndex][3];
+		}
+	}
+
+	/*******************************************************
+	 *  DecodeBCImage()
+	 *
+	 *  This function unpacks one mip level of BC1/BC2/BC3
+	 *  block data into tightly packed RGBA pixels.
+	 *******************************************************/
+	void DecodeBCImage(
+		const unsigned char* blockData,
+		int width,
+		int height,
+		BC_VARIANT variant,
+		std::vector<unsigned char>& rgbaPixels)
+	{
+		rgbaPixels.resize((size_t)width * height * 4);
+
+		int blockColumns = (width + 3) / 4;
+		int blockRows = (height + 3) / 4;
+		int blockSize = (variant == BC_VARIANT_BC1) ? 8 : 16;
+
+		for (int blockRow = 0; blockRow < blockRows; blockRow++)
+		{
+			for (int blockColumn = 0; blockColumn < blockColumns; blockColumn++)
+			{
+				const unsigned char* block = blockData +
+					((size_t)blockRow * blockColumns + blockColumn) * blockSize;
+
+				unsigned char pixels[16][4];
+				DecodeColorBlock(
+					block + ((variant == BC_VARIANT_BC1) ? 0 : 8),
+					variant != BC_VARIANT_BC1,
+					pixels);
+
+				if (variant == BC_VARIANT_BC2)
+				{
+					// explicit 4-bit alpha per pixel
+					for (int pixel = 0; pixel < 16; pixel++)
+					{
+						int alpha = (block[pixel / 2] >> ((pixel % 2) * 4)) & 15;
+						pixels[pixel][3] = (unsigned char)(alpha * 255 / 15);
+					}
+				}
+				else if (variant == BC_VARIANT_BC3)
+				{
+					// interpolated alpha from two reference values
+					// plus 3-bit indices
+					unsigned char alphaPalette[8];
+					alphaPalette[0] = block[0];
+					alphaPalette[1] = block[1];
+					if (alphaPalette[0] > alphaPalette[1])
+					{
+						for (int entry = 2; entry < 8; entry++)
+						{
+							alphaPalette[entry] = (unsigned char)(
+								((8 - entry) * alphaPalette[0] +
+									(entry - 1) * alphaPalette[1]) / 7);
+						}
+					}
+					else
+					{
+						for (int entry = 2; entry < 6; entry++)
+						{
+							alphaPalette[entry] = (unsigned char)(
+								((6 - entry) * alphaPalette[0] +
+									(entry - 1) * alphaPalette[1]) / 5);
+						}
+						alphaPalette[6] = 0;
+						alphaPalette[7] = 255;
+					}
+
+					uint64_t alphaBits = 0;
+					for (int byte = 0; byte < 6; byte++)
+					{
+						alphaBits |= (uint64_t)block[2 + byte] << (byte * 8);
+					}
+					for (int pixel = 0; pixel < 16; pixel++)
+					{
+						pixels[pixel][3] =
+							alphaPalette[(alphaBits >> (pixel * 3)) & 7];
+					}
+				}
+
+				// scatter the decoded 4 x 4 block into the image,
+				// clipping against non multiple-of-four edges
+				for (int pixel = 0; pixel < 16; pixel++)
+				{
+					int x = blockColumn * 4 + (pixel % 4);
+					int y = blockRow * 4 + (pixel / 4);
+					if ((x >= width) || (y >= height))
+					{
+						continue;
+					}
+
+					unsigned char* destination =
+						&rgbaPixels[((size_t)y * width + x) * 4];
+					destination[0] = pixels[pixel][0];
+					destination[1] = pixels[pixel][1];
+					destination[2] = pixels[pixel][2];
+					destination[3] = pixels[pixel][3];
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  IsDDSFile()
+ *
+ *  This method returns true when the passed in filename
+ *  ends with the .dds extension.
+ ***********************************************************/
+bool SceneManager::IsDDSFile(const char* filename)
+{
+	std::string name = filename;
+	if (name.length() < 4)
+	{
+		return(false);
+	}
+
+	std::string extension = name.substr(name.length() - 4);
+	for (size_t i = 0; i < extension.length(); i++)
+	{
+		extension[i] = (char)tolower((unsigned char)extension[i]);
+	}
+
+	return(extension == ".dds");
+}
+
+/***********************************************************
+ *  LoadDDSTexture()
+ *
+ *  This method loads a precompressed DDS texture - BC1/BC2/
+ *  BC3 from the classic fourCC header - unpacking the blocks
+ *  on the CPU into the texture's layer of the shared array,
+ *  since the RGBA8 array cannot store compressed layers.
+ ***********************************************************/
+bool SceneManager::LoadDDSTexture(const char* filename, std::string tag)
+{
+	// the file bytes - a zero-copy slice of the mapped archive
+	// when the texture is packed, otherwise one read of the
+	// loose file
+	const unsigned char* fileData = NULL;
+	size_t fileSize = 0;
+	std::vector<unsigned char> fileBytes;
+
+	if (AssetPack::Instance().GetAsset(filename, fileData, fileSize) == false)
+	{
+		FILE* file = NULL;
+#if defined(_MSC_VER)
+		fopen_s(&file, filename, "rb");
+#else
+		file = fopen(filename, "rb");
+#endif
+		if (file == NULL)
+		{
+			std::cout << "Could not load image:" << filename << std::endl;
+			return(false);
+		}
+
+		fseek(file, 0, SEEK_END);
+		long looseFileSize = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		fileBytes.resize(looseFileSize);
+		size_t bytesRead = fread(fileBytes.data(), 1, looseFileSize, file);
+		fclose(file);
+
+		if (bytesRead != (size_t)looseFileSize)
+		{
+			std::cout << "Could not load image:" << filename << std::endl;
+			return(false);
+		}
+
+		fileData = fileBytes.data();
+		fileSize = fileBytes.size();
+	}
+
+	if ((fileSize < 4 + sizeof(DDS_HEADER)) ||
+		(memcmp(fileData, "DDS ", 4) != 0))
+	{
+		std::cout << "Not a valid DDS file:" << filename << std::endl;
+		return(false);
+	}
+
+	const DDS_HEADER* header = (const DDS_HEADER*)(fileData + 4);
+	const unsigned char* blockData = fileData + 4 + sizeof(DDS_HEADER);
+
+	// map the pixel format onto a block variant the CPU
+	// unpacker handles - the shared RGBA8 texture array cannot
+	// hold compressed layers, so the blocks are unpacked once
+	// at load instead
+	BC_VARIANT variant = BC_VARIANT_NONE;
+
+	if (header->ddspf.dwFourCC == MakeFourCC('D', 'X', 'T', '1'))
+	{
+		variant = BC_VARIANT_BC1;
+	}
+	else if (header->ddspf.dwFourCC == MakeFourCC('D', 'X', 'T', '3'))
+	{
+		variant = BC_VARIANT_BC2;
+	}
+	else if (header->ddspf.dwFourCC == MakeFourCC('D', 'X', 'T', '5'))
+	{
+		variant = BC_VARIANT_BC3;
+	}
+	else if (header->ddspf.dwFourCC == MakeFourCC('D', 'X', '1', '0'))
+	{
+		// BC7 has no practical CPU unpacker here - reauthor such
+		// files as DXT1/DXT5 to use them with the texture array
+		std::cout << "Not implemented to unpack the DX10 DDS format in:" << filename << std::endl;
+		return(false);
+	}
+
+	if (variant == BC_VARIANT_NONE)
+	{
+		std::cout << "Not implemented to handle the DDS pixel format in:" << filename << std::endl;
+		return(false);
+	}
+
+	// unpack the top mip level - the array regenerates its own
+	// chain on upload
+	std::vector<unsigned char> rgbaPixels;
+	DecodeBCImage(blockData,
+		(int)header->dwWidth, (int)header->dwHeight, variant, rgbaPixels);
+
+	int layer = m_textureArray->AllocateLayer();
+	if (layer < 0)
+	{
+		return(false);
+	}
+
+	m_textureArray->UploadLayer(layer, rgbaPixels.data(),
+		(int)header->dwWidth, (int)header->dwHeight, 4);
+
+	std::cout << "Successfully loaded image:" << filename << ", width:" << header->dwWidth << ", height:" << header->dwHeight << std::endl;
+
+	// register the layer and associate it with the special tag
+	// string - BC2/BC3 blocks carry real alpha, BC1 is opaque
+	m_textureSlotMap[HashTag(tag)] = layer;
+	MarkTextureAlpha(layer, (variant != BC_VARIANT_BC1));
+
+	return(true);
+}
+
+/***********************************************************
+ *  QueueTextureLoad()
+ *
+ *  This method reserves a placeholder layer for the passed
+ *  in tag so the scene can render immediately, and queues
+ *  the image file for decoding on the worker pool - the
+ *  real pixels are uploaded by UpdateAsyncTextureLoads()
+ *  once a worker has finished the decode.
+ ***********************************************************/
+void SceneManager::QueueTextureLoad(const char* filename, std::string tag)
+{
+	// DDS files carry GPU-ready blocks, so the unpack into the
+	// array is cheap enough to run inline - no need for the
+	// worker pool or a placeholder
+	if (IsDDSFile(filename))
+	{
+		LoadDDSTexture(filename, tag);
+		return;
+	}
+
+	// reserve the layer now - it renders neutral gray until the
+	// decode lands, and the tag resolves to a valid handle
+	// right away
+	int layer = m_textureArray->AllocateLayer();
+	if (layer < 0)
+	{
+		return;
+	}
+
+	m_textureSlotMap[HashTag(tag)] = layer;
+
+	TEXTURE_LOAD_TASK task;
+	task.filename = filename;
+	task.textureSlot = layer;
+	m_textureLoadTasks.push_back(task);
+	m_pendingTextureLoads++;
+}
+
+/***********************************************************
+ *  UpdateAsyncTextureLoads()
+ *
+ *  This method uploads texture decodes the worker pool has
+ *  finished into their reserved array layers - at most one
+ *  layer per frame, so a burst of finished decodes costs a
+ *  bounded slice of every frame instead of one long hitch.
+ ***********************************************************/
+void SceneManager::UpdateAsyncTextureLoads()
+{
+	if (m_pendingTextureLoads == 0)
+	{
+		return;
+	}
+
+	// take one finished decode from the workers - the rest
+	// stay queued for the following frames
+	TEXTURE_LOAD_RESULT result;
+	{
+		std::lock_guard<std::mutex> resultsLock(m_textureResultsMutex);
+		if (m_textureResults.empty() == true)
+		{
+			return;
+		}
+		result = std::move(m_textureResults.front());
+		m_textureResults.erase(m_textureResults.begin());
+	}
+
+	m_pendingTextureLoads--;
+
+	if (result.mipPixels.empty() == true)
+	{
+		std::cout << "Could not load image:" << result.filename << std::endl;
+	}
+	else
+	{
+		std::cout << "Successfully loaded image:" << result.filename << ", width:" << result.width << ", height:" << result.height << ", channels:" << result.colorChannels << std::endl;
+
+		// replace the placeholder pixels in the texture's
+		// reserved layer - the pyramid was built on the worker,
+		// so this is per-level transfers and nothing else
+		m_textureArray->UploadLayerMips(result.textureSlot, result.mipPixels);
+		MarkTextureAlpha(result.textureSlot, (result.colorChannels == 4));
+	}
+
+	// once every decode has been consumed the workers are done
+	if (m_pendingTextureLoads == 0)
+	{
+		for (size_t worker = 0; worker < m_textureWorkers.size(); worker++)
+		{
+			if (m_textureWorkers[worker].joinable())
+			{
+				m_textureWorkers[worker].join();
+			}
+		}
+		m_textureWorkers.clear();
+		m_textureLoadTasks.clear();
+	}
+}
+
+/***********************************************************
+ *  IsSceneDirty()
+ *
+ *  This method returns true when the scene has changed since
+ *  the last rendered frame - while texture decodes are still
+ *  outstanding the scene keeps reporting dirty, so their
+ *  uploads reach the screen.
+ ***********************************************************/
+bool SceneManager::IsSceneDirty() const
+{
+	return((m_bSceneChanged == true) || (m_pendingTextureLoads > 0));
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method binds the shared texture array to its unit -
+ *  done once, every draw then selects its texture by layer
+ *  index instead of a sampler rebind.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	m_textureArray->Bind(0);
+}
+
+/***********************************************************
+ *  MarkTextureAlpha()
+ *
+ *  This method records whether the passed in texture layer
+ *  carries an alpha channel - the render passes use this to
+ *  route nodes between the opaque and transparent pass.
+ ***********************************************************/
+void SceneManager::MarkTextureAlpha(int layer, bool bHasAlpha)
+{
+	if (layer < 0)
+	{
+		return;
+	}
+
+	if ((int)m_textureLayerHasAlpha.size() <= layer)
+	{
+		m_textureLayerHasAlpha.resize(layer + 1, false);
+	}
+	m_textureLayerHasAlpha[layer] = bHasAlpha;
+}
+
+/***********************************************************
+ *  IsNodeTransparent()
+ *
+ *  This method returns true when the passed in node must be
+ *  drawn in the blended back-to-front pass - its texture
+ *  decoded with an alpha channel, or its solid color has an
+ *  alpha value below one.
+ ***********************************************************/
+bool SceneManager::IsNodeTransparent(const SCENE_NODE& node) const
+{
+	if (node.textureHandle >= 0)
+	{
+		return((node.textureHandle < (int)m_textureLayerHasAlpha.size()) &&
+			(m_textureLayerHasAlpha[node.textureHandle] == true));
+	}
+
+	return(node.color.a < 1.0f);
+}
+
+/***********************************************************
+ *  HashTag()
+ *
+ *  This method computes the 64-bit FNV-1a hash for the
+ *  passed in tag string - the texture and material
+ *  registries are keyed by this hash value.
+ ***********************************************************/
+uint64_t SceneManager::HashTag(std::string_view tag)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < tag.length(); i++)
+	{
+		hash ^= (uint64_t)(unsigned char)tag[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  GetTextureHandle()
+ *
+ *  This method resolves the passed in tag into the slot
+ *  handle for the previously loaded texture, or -1 when no
+ *  texture has been registered with the tag.
+ ***********************************************************/
+int SceneManager::GetTextureHandle(std::string_view tag) const
+{
+	auto registered = m_textureSlotMap.find(HashTag(tag));
+	if (registered == m_textureSlotMap.end())
+	{
+		return(-1);
+	}
+
+	return(registered->second);
+}
+
+/***********************************************************
+ *  GetMaterialHandle()
+ *
+ *  This method resolves the passed in tag into the index
+ *  handle for the previously defined material, or -1 when
+ *  no material has been registered with the tag.
+ ***********************************************************/
+int SceneManager::GetMaterialHandle(std::string_view tag) const
+{
+	auto registered = m_materialMap.find(HashTag(tag));
+	if (registered == m_materialMap.end())
+	{
+		return(-1);
+	}
+
+	return(registered->second);
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag -
+ *  with the array backend the ID is the layer index.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string_view tag)
+{
+	return(GetTextureHandle(tag));
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string_view tag)
+{
+	return(GetTextureHandle(tag));
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in
+ *  tag - the returned pointer aims into the registry, so nothing
+ *  is copied per call; null when the tag is unknown.
+ ***********************************************************/
+const SceneManager::OBJECT_MATERIAL* SceneManager::FindMaterial(std::string_view tag) const
+{
+	int materialHandle = GetMaterialHandle(tag);
+	if (materialHandle < 0)
+	{
+		return(NULL);
+	}
+
+	return(&m_objectMaterials[materialHandle]);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	UniformCache::Instance().setMat4Value(g_ModelName, ComputeModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ));
+}
+
+/***********************************************************
+ *  ComputeModelMatrix()
+ *
+ *  This method composes a model matrix from the passed in
+ *  transformation values.
+ ***********************************************************/
+glm::mat4 SceneManager::ComputeModelMatrix(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	return(translation * rotationX * rotationY * rotationZ * scale);
+}
+
+/***********************************************************
+ *  AddSceneNode()
+ *
+ *  This method adds the passed in node to the retained
+ *  scene and returns its index - the node is added dirty
+ *  so its model matrix is computed before the first frame.
+ ***********************************************************/
+int SceneManager::AddSceneNode(const SCENE_NODE& node)
+{
+	m_sceneNodes.push_back(node);
+	m_sceneNodes.back().bDirty = true;
+	m_bRenderQueueDirty = true;
+	m_bSceneChanged = true;
+
+	return((int)m_sceneNodes.size() - 1);
+}
+
+/***********************************************************
+ *  BuildRenderQueue()
+ *
+ *  This method rebuilds the render queue - the node indexes
+ *  are sorted by (shader permutation, texture, material,
+ *  mesh) so draws that share a program and its state are
+ *  submitted back to back, and the program switches and
+ *  redundant state changes between them can be skipped.
+ ***********************************************************/
+void SceneManager::BuildRenderQueue()
+{
+	// group repeated tapered cylinders that share texture,
+	// material and color into instanced batches - those nodes
+	// leave the per-draw queue entirely; the indirect path
+	// submits every draw in one call already, so it keeps all
+	// of the nodes in the sorted queue instead
+	m_instancedBatches.clear();
+	std::vector<bool> nodeInBatch(m_sceneNodes.size(), false);
+
+	for (int index = 0;
+		(index < (int)m_sceneNodes.size()) && (m_bUseIndirectPath == false);
+		index++)
+	{
+		const SCENE_NODE& node = m_sceneNodes[index];
+
+		if ((node.meshShape != MESH_TAPERED_CYLINDER) || (nodeInBatch[index] == true))
+		{
+			continue;
+		}
+
+		std::vector<int> matchingNodes;
+		for (int other = index; other < (int)m_sceneNodes.size(); other++)
+		{
+			const SCENE_NODE& candidate = m_sceneNodes[other];
+			if ((candidate.meshShape == node.meshShape) &&
+				(candidate.textureHandle == node.textureHandle) &&
+				(candidate.materialHandle == node.materialHandle) &&
+				(candidate.color == node.color) &&
+				(nodeInBatch[other] == false))
+			{
+				matchingNodes.push_back(other);
+			}
+		}
+
+		// one instanced draw only pays off past a few copies
+		if ((int)matchingNodes.size() >= 4)
+		{
+			INSTANCED_BATCH batch;
+			batch.meshShape = node.meshShape;
+			batch.textureHandle = node.textureHandle;
+			batch.materialHandle = node.materialHandle;
+			batch.color = node.color;
+			batch.nodeIndexes = matchingNodes;
+			m_instancedBatches.push_back(batch);
+
+			for (size_t match = 0; match < matchingNodes.size(); match++)
+			{
+				nodeInBatch[matchingNodes[match]] = true;
+			}
+		}
+	}
+
+	m_renderQueue.clear();
+	m_renderQueue.reserve(m_sceneNodes.size());
+	for (int index = 0; index < (int)m_sceneNodes.size(); index++)
+	{
+		if (nodeInBatch[index] == false)
+		{
+			m_renderQueue.push_back(index);
+		}
+	}
+
+	std::sort(m_renderQueue.begin(), m_renderQueue.end(),
+		[this](int leftIndex, int rightIndex)
+		{
+			const SCENE_NODE& left = m_sceneNodes[leftIndex];
+			const SCENE_NODE& right = m_sceneNodes[rightIndex];
+
+			// every scene node is lit - the permutation key only
+			// splits on whether the node samples a texture
+			int leftVariant = ShaderVariants::VariantIndex(left.textureHandle >= 0, true);
+			int rightVariant = ShaderVariants::VariantIndex(right.textureHandle >= 0, true);
+			if (leftVariant != rightVariant)
+				return(leftVariant < rightVariant);
+			if (left.textureHandle != right.textureHandle)
+				return(left.textureHandle < right.textureHandle);
+			if (left.materialHandle != right.materialHandle)
+				return(left.materialHandle < right.materialHandle);
+			return(left.meshShape < right.meshShape);
+		});
+
+	m_bRenderQueueDirty = false;
+}
+
+/***********************************************************
+ *  FillPerObjectData()
+ *
+ *  This method fills one indirect per-object record from a
+ *  scene node - the model matrix, material values, and the
+ *  texture slot or solid color.
+ ***********************************************************/
+void SceneManager::FillPerObjectData(
+	const SCENE_NODE& node,
+	IndirectRenderer::PER_OBJECT_DATA& objectData) const
+{
+	objectData.model = node.modelMatrix;
+	objectData.color = node.color;
+
+	if ((node.materialHandle >= 0) &&
+		(node.materialHandle < (int)m_objectMaterials.size()))
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[node.materialHandle];
+		objectData.ambient = glm::vec4(material.ambientColor, material.ambientStrength);
+		objectData.diffuse = glm::vec4(material.diffuseColor, material.shininess);
+		objectData.specular = glm::vec4(material.specularColor, 0.0f);
+	}
+	else
+	{
+		// neutral material for nodes drawn without one
+		objectData.ambient = glm::vec4(1.0f, 1.0f, 1.0f, 0.2f);
+		objectData.diffuse = glm::vec4(1.0f, 1.0f, 1.0f, 8.0f);
+		objectData.specular = glm::vec4(0.0f);
+	}
+
+	objectData.params = glm::vec4(
+		(float)node.textureHandle, node.uvScale.x, node.uvScale.y, 0.0f);
+}
+
+/***********************************************************
+ *  SetNodeTransform()
+ *
+ *  This method updates the transform of an existing scene
+ *  node and marks it dirty so only moved nodes pay for a
+ *  model matrix recompute.
+ ***********************************************************/
+void SceneManager::SetNodeTransform(
+	int nodeIndex,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((nodeIndex < 0) || (nodeIndex >= (int)m_sceneNodes.size()))
+	{
+		return;
+	}
+
+	SCENE_NODE& node = m_sceneNodes[nodeIndex];
+	node.scaleXYZ = scaleXYZ;
+	node.XrotationDegrees = XrotationDegrees;
+	node.YrotationDegrees = YrotationDegrees;
+	node.ZrotationDegrees = ZrotationDegrees;
+	node.positionXYZ = positionXYZ;
+	node.bDirty = true;
+	m_bSceneChanged = true;
+}
+
+/***********************************************************
+ *  UpdateSceneNodes()
+ *
+ *  This method recomputes the model matrices for any scene
+ *  nodes whose transforms have changed since the last frame
+ *  - the dirty nodes are gathered into SoA staging and their
+ *  matrices are composed four at a time by the SIMD kernel,
+ *  split across the job system's worker pool.
+ ***********************************************************/
+void SceneManager::UpdateSceneNodes()
+{
+	// gather the dirty nodes and stage their transform
+	// components in SoA form for the kernel
+	m_dirtyNodeScratch.clear();
+	for (int index = 0; index < (int)m_sceneNodes.size(); index++)
+	{
+		if (m_sceneNodes[index].bDirty == true)
+		{
+			m_dirtyNodeScratch.push_back(index);
+		}
+	}
+
+	int dirtyCount = (int)m_dirtyNodeScratch.size();
+	if (dirtyCount == 0)
+	{
+		return;
+	}
+
+	m_transformScratch.Resize(dirtyCount);
+	m_dirtyMatrixScratch.resize(dirtyCount);
+	for (int dirty = 0; dirty < dirtyCount; dirty++)
+	{
+		const SCENE_NODE& node = m_sceneNodes[m_dirtyNodeScratch[dirty]];
+		m_transformScratch.scaleX[dirty] = node.scaleXYZ.x;
+		m_transformScratch.scaleY[dirty] = node.scaleXYZ.y;
+		m_transformScratch.scaleZ[dirty] = node.scaleXYZ.z;
+		m_transformScratch.rotationDegreesX[dirty] = node.XrotationDegrees;
+		m_transformScratch.rotationDegreesY[dirty] = node.YrotationDegrees;
+		m_transformScratch.rotationDegreesZ[dirty] = node.ZrotationDegrees;
+		m_transformScratch.positionX[dirty] = node.positionXYZ.x;
+		m_transformScratch.positionY[dirty] = node.positionXYZ.y;
+		m_transformScratch.positionZ[dirty] = node.positionXYZ.z;
+	}
+
+	JobSystem::Instance().ParallelFor(
+		dirtyCount, 64,
+		[this](int rangeBegin, int rangeEnd, int threadIndex)
+		{
+			// compose this range of the batch in SIMD
+			TransformKernel::ComposeModelMatrices(
+				m_transformScratch,
+				rangeBegin, rangeEnd,
+				m_dirtyMatrixScratch.data());
+
+			// scatter the matrices back to their nodes along
+			// with the refreshed bounds
+			for (int dirty = rangeBegin; dirty < rangeEnd; dirty++)
+			{
+				SCENE_NODE& node = m_sceneNodes[m_dirtyNodeScratch[dirty]];
+				node.modelMatrix = m_dirtyMatrixScratch[dirty];
+
+				// refresh the world-space bounding sphere for the
+				// visibility pass - the radius scales with the
+				// largest scale axis to stay conservative
+				glm::vec3 localCenter;
+				float localRadius;
+				GetMeshLocalBounds(node.meshShape, localCenter, localRadius);
+
+				float maxScale = fabs(node.scaleXYZ.x);
+				if (fabs(node.scaleXYZ.y) > maxScale)
+					maxScale = fabs(node.scaleXYZ.y);
+				if (fabs(node.scaleXYZ.z) > maxScale)
+					maxScale = fabs(node.scaleXYZ.z);
+
+				node.boundingCenter = glm::vec3(node.modelMatrix * glm::vec4(localCenter, 1.0f));
+				node.boundingRadius = localRadius * maxScale;
+
+				node.bDirty = false;
+			}
+		});
+}
+
+/***********************************************************
+ *  GetMeshLocalBounds()
+ *
+ *  This method returns a conservative local-space bounding
+ *  sphere for the passed in basic shape, which the culling
+ *  pass transforms into world space per node.
+ ***********************************************************/
+void SceneManager::GetMeshLocalBounds(
+	MESH_SHAPE meshShape,
+	glm::vec3& localCenter,
+	float& localRadius)
+{
+	switch (meshShape)
+	{
+	case MESH_PLANE:
+		localCenter = glm::vec3(0.0f);
+		localRadius = 1.5f;
+		break;
+	case MESH_BOX:
+		localCenter = glm::vec3(0.0f);
+		localRadius = 0.9f;
+		break;
+	case MESH_CONE:
+	case MESH_TAPERED_CYLINDER:
+	case MESH_CYLINDER:
+		// these shapes extend from their base upward
+		localCenter = glm::vec3(0.0f, 0.5f, 0.0f);
+		localRadius = 1.2f;
+		break;
+	case MESH_SPHERE:
+		localCenter = glm::vec3(0.0f);
+		localRadius = 1.1f;
+		break;
+	default:
+		localCenter = glm::vec3(0.0f);
+		localRadius = 1.2f;
+		break;
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method issues the draw call for the passed in mesh
+ *  shape out of the mesh library's shared buffers - the
+ *  MESH_SHAPE values mirror the library's MESH_ID order.
+ ***********************************************************/
+void SceneManager::DrawMesh(MESH_SHAPE meshShape, int lodLevel)
+{
+	m_meshLibrary->DrawMesh((MeshLibrary::MESH_ID)meshShape, lodLevel);
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	UniformCache::Instance().setVec4Value(g_ColorValueName, currentColor);
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in tag into the shader - the
+ *  tag is a view, so the call allocates nothing.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string_view textureTag)
+{
+	SetShaderTexture(GetTextureHandle(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for selecting the texture associated
+ *  with the passed in layer handle in the shader - just an
+ *  integer layer index now, the array itself stays bound -
+ *  the handle overload is the one the per-frame draw path
+ *  should use.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	int textureHandle)
+{
+	UniformCache::Instance().setIntValue(g_TextureLayerName, textureHandle);
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	UniformCache::Instance().setVec2Value("UVscale", glm::vec2(u, v));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader - the tag is a view, so the call
+ *  allocates nothing.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string_view materialTag)
+{
+	SetShaderMaterial(GetMaterialHandle(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  associated with the passed in handle into the shader -
+ *  the handle overload is the one the per-frame draw path
+ *  should use.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	int materialHandle)
+{
+	if ((materialHandle >= 0) && (materialHandle < (int)m_objectMaterials.size()))
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[materialHandle];
+
+		UniformCache::Instance().setVec3Value("material.ambientColor", material.ambientColor);
+		UniformCache::Instance().setFloatValue("material.ambientStrength", material.ambientStrength);
+		UniformCache::Instance().setVec3Value("material.diffuseColor", material.diffuseColor);
+		UniformCache::Instance().setVec3Value("material.specularColor", material.specularColor);
+		UniformCache::Instance().setFloatValue("material.shininess", material.shininess);
+	}
+}
+/**************************************************************/
+/* Setting up the lighting */
+void SceneManager::SetupSceneLights()
+{
+	// the whole lighting rig goes through the shared uniform
+	// block - one transfer when it changes, none per frame
+	UniformBlocks::LIGHTING_BLOCK lightingBlock;
+
+	lightingBlock.dirLightDirection = glm::vec4(-0.5f, -0.8f, 0.8f, 0.0f);
+	lightingBlock.dirLightAmbient = glm::vec4(0.3f, 0.3f, 0.3f, 0.0f);
+	lightingBlock.dirLightDiffuse = glm::vec4(0.7f, 0.7f, 0.7f, 0.0f);
+
+	lightingBlock.spotLightPosition = glm::vec4(5.5f, 4.0f, 0.5f, 1.0f);
+	lightingBlock.spotLightDirection = glm::vec4(-0.8f, -1.0f, -0.2f, 0.0f);
+
+	lightingBlock.spotLightAmbient = glm::vec4(0.1f, 0.1f, 0.1f, 0.0f);
+	lightingBlock.spotLightDiffuse = glm::vec4(1.0f, 0.95f, 0.8f, 0.0f); // Warm bulb color
+	lightingBlock.spotLightSpecular = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+
+	lightingBlock.spotLightAttenuation = glm::vec4(1.0f, 0.045f, 0.0075f, 0.0f);
+
+	lightingBlock.spotLightCone = glm::vec4(
+		glm::cos(glm::radians(15.0f)),
+		glm::cos(glm::radians(25.0f)),
+		0.0f, 0.0f);
+
+	UniformBlocks::Instance().SetLightingBlock(lightingBlock);
+}
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	LoadSceneTextures();
+	LoadSceneMaterials();
+	// every basic shape is generated once into the library's
+	// shared vertex and index buffers no matter how many times
+	// it is drawn in the rendered 3D scene
+	m_meshLibrary->LoadMeshes();
+
+	// load the instanced mesh path used for repeated shapes
+	m_instancedMeshes->LoadTaperedCylinderMesh();
+
+	// the indirect submission path reads its per-draw state by
+	// gl_DrawID, which needs a GL 4.6 context - fall back to
+	// the sorted per-draw queue on older drivers
+	if (GLEW_VERSION_4_6)
+	{
+		m_indirectRenderer->Create();
+		m_bUseIndirectPath = true;
+		std::cout << "INFO: Using multi-draw-indirect scene submission" << std::endl;
+	}
+
+	// the occlusion query backend - draws hidden behind the
+	// large occluders are skipped once a query proves it
+	m_occlusionCuller->Create();
+
+	// resolve the texture and material tags used by the scene
+	// into integer handles once, so the render loop never
+	// performs a string lookup
+	m_wallTexture = GetTextureHandle("wall");
+	m_woodTexture = GetTextureHandle("wood");
+	m_leafTexture = GetTextureHandle("leaf");
+	m_wallMaterial = GetMaterialHandle("wall");
+	m_graniteMaterial = GetMaterialHandle("granite");
+	m_lampMaterial = GetMaterialHandle("lamp");
+	m_goldMaterial = GetMaterialHandle("gold");
+	m_marbleMaterial = GetMaterialHandle("marble");
+
+	// build the retained scene node array once - the render
+	// loop just iterates the nodes from here on
+	BuildScene();
+}
+void SceneManager::LoadSceneMaterials()
+{
+
+	OBJECT_MATERIAL marble;
+	marble.tag = "marble";
+	marble.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f); 
+	marble.ambientStrength = 0.4f;
+	marble.diffuseColor = glm::vec3(0.9f, 0.9f, 0.9f); 
+	marble.specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	marble.shininess = 16.0f;
+	m_objectMaterials.push_back(marble);
+
+	OBJECT_MATERIAL gold;
+	gold.tag = "gold";
+	gold.ambientColor = glm::vec3(0.25f, 0.20f, 0.07f);
+	gold.ambientStrength = 0.3f;
+	gold.diffuseColor = glm::vec3(0.8f, 0.65f, 0.25f);  
+	gold.specularColor = glm::vec3(0.65f, 0.55f, 0.35f);
+	gold.shininess = 51.2f;
+	m_objectMaterials.push_back(gold);
+
+	OBJECT_MATERIAL granite;
+	granite.tag = "granite";
+	granite.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	granite.ambientStrength = 0.35f;
+	granite.diffuseColor = glm::vec3(0.6f, 0.6f, 0.6f);
+	granite.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	granite.shininess = 8.0f;
+	m_objectMaterials.push_back(granite);
+
+	OBJECT_MATERIAL wall;
+	wall.tag = "wall";
+	wall.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	wall.ambientStrength = 0.5f;
+	wall.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	wall.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+	wall.shininess = 1.0f;
+	m_objectMaterials.push_back(wall);
+
+	OBJECT_MATERIAL lamp;
+	lamp.tag = "lamp";
+	lamp.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	lamp.ambientStrength = 0.5f;
+	lamp.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	lamp.specularColor = glm::vec3(0.2f, 0.2f, 0.2f); // Low shine
+	lamp.shininess = 2.0f;
+	m_objectMaterials.push_back(lamp);
+
+	// build the registry mapping hashed tags to material
+	// indexes so render-time lookups never scan the list
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		m_materialMap[HashTag(m_objectMaterials[index].tag)] = index;
+	}
+}
+/**************************************************************/
+/* LoadingScreenTexture() */
+void SceneManager::LoadSceneTextures() {
+	// the array holding every scene texture - allocated before
+	// any layer is reserved
+	m_textureArray->Create();
+
+	// reserve placeholder layers and queue every file for
+	// decode - PrepareScene() returns without waiting on any
+	// image
+	QueueTextureLoad("textures/wood.jpg", "wood");
+	QueueTextureLoad("textures/wall.jpg", "wall");
+	QueueTextureLoad("textures/pot.jpg", "pot");
+	QueueTextureLoad("textures/leaf.jpg", "leaf");
+	QueueTextureLoad("textures/lamp.jpg", "lamp");
+	QueueTextureLoad("textures/marble.jpg", "marble");
+	QueueTextureLoad("textures/granite.jpg", "granite");
+	QueueTextureLoad("textures/gold.jpg", "gold");
+
+	// the flip setting is process global - set it once before
+	// the workers start decoding
+	stbi_set_flip_vertically_on_load(true);
+
+	// spin up the decode workers - each pulls the next queued
+	// file until the task list is drained
+	int workerCount = (int)std::thread::hardware_concurrency();
+	if (workerCount < 1)
+	{
+		workerCount = 1;
+	}
+	if (workerCount > (int)m_textureLoadTasks.size())
+	{
+		workerCount = (int)m_textureLoadTasks.size();
+	}
+
+	for (int worker = 0; worker < workerCount; worker++)
+	{
+		m_textureWorkers.push_back(std::thread([this]()
+		{
+			while (true)
+			{
+				int taskIndex = m_nextTextureTask.fetch_add(1);
+				if (taskIndex >= (int)m_textureLoadTasks.size())
+				{
+					break;
+				}
+
+				const TEXTURE_LOAD_TASK& task = m_textureLoadTasks[taskIndex];
+
+				TEXTURE_LOAD_RESULT result;
+				result.filename = task.filename;
+				result.textureSlot = task.textureSlot;
+
+				// decode from the mapped archive slice when the
+				// image is packed - no file open at all
+				unsigned char* pixels = NULL;
+				const unsigned char* packData = NULL;
+				size_t packSize = 0;
+				if (AssetPack::Instance().GetAsset(
+					task.filename.c_str(), packData, packSize))
+				{
+					pixels = stbi_load_from_memory(
+						packData,
+						(int)packSize,
+						&result.width,
+						&result.height,
+						&result.colorChannels,
+						0);
+				}
+				else
+				{
+					pixels = stbi_load(
+						task.filename.c_str(),
+						&result.width,
+						&result.height,
+						&result.colorChannels,
+						0);
+				}
+
+				// resample and mip the decode right here in the
+				// background - the GL thread then only pays for
+				// the per-level transfers
+				if (pixels != NULL)
+				{
+					m_textureArray->BuildLayerMips(
+						pixels,
+						result.width,
+						result.height,
+						result.colorChannels,
+						result.mipPixels);
+					stbi_image_free(pixels);
+				}
+
+				std::lock_guard<std::mutex> resultsLock(m_textureResultsMutex);
+				m_textureResults.push_back(std::move(result));
+			}
+		}));
+	}
+
+	BindGLTextures();
+}
+/***********************************************************
+ *  BuildScene()
+ *
+ *  This method builds the retained scene node array. The
+ *  placements come from the scene description file when one
+ *  is present - the first launch parses the text and later
+ *  launches load the compiled binary cache with a single
+ *  read. The built-in placements remain the fallback when
+ *  no scene file is shipped.
+ ***********************************************************/
+void SceneManager::BuildScene()
+{
+	std::vector<SceneFile::SCENE_FILE_RECORD> records;
+	if (SceneFile::Load("scene.txt", "scene.bin", records) == false)
+	{
+		BuildDefaultScene();
+		return;
+	}
+
+	for (size_t index = 0; index < records.size(); index++)
+	{
+		const SceneFile::SCENE_FILE_RECORD& record = records[index];
+
+		SCENE_NODE node;
+		node.meshShape = (MESH_SHAPE)record.meshShape;
+		node.scaleXYZ = glm::vec3(
+			record.scaleXYZ[0], record.scaleXYZ[1], record.scaleXYZ[2]);
+		node.XrotationDegrees = record.rotationDegreesXYZ[0];
+		node.YrotationDegrees = record.rotationDegreesXYZ[1];
+		node.ZrotationDegrees = record.rotationDegreesXYZ[2];
+		node.positionXYZ = glm::vec3(
+			record.positionXYZ[0], record.positionXYZ[1], record.positionXYZ[2]);
+		node.uvScale = glm::vec2(record.uvScale[0], record.uvScale[1]);
+		node.color = glm::vec4(
+			record.color[0], record.color[1], record.color[2], record.color[3]);
+
+		// the records carry tags rather than handles, because the
+		// handles depend on the asset load order of this run
+		if (record.textureTag[0] != '\0')
+		{
+			node.textureHandle = GetTextureHandle(record.textureTag);
+		}
+		if (record.materialTag[0] != '\0')
+		{
+			node.materialHandle = GetMaterialHandle(record.materialTag);
+		}
+
+		AddSceneNode(node);
+	}
+}
+
+/***********************************************************
+ *  BuildDefaultScene()
+ *
+ *  This method builds the built-in scene placements - every
+ *  object placement that used to be issued immediate-mode in
+ *  RenderScene() is captured here once, with its transform,
+ *  material handle, and texture handle.
+ ***********************************************************/
+void SceneManager::BuildDefaultScene()
+{
+	SCENE_NODE node;
+
+	// The back wall
+	node = SCENE_NODE();
+	node.meshShape = MESH_PLANE;
+	node.scaleXYZ = glm::vec3(40.0f, 1.0f, 40.0f);
+	node.XrotationDegrees = -90.0f;
+	node.positionXYZ = glm::vec3(0.0f, 4.0f, -10.0f);
+	node.textureHandle = m_wallTexture;
+	node.materialHandle = m_wallMaterial;
+	AddSceneNode(node);
+
+	// Desk Surface
+	node = SCENE_NODE();
+	node.meshShape = MESH_PLANE;
+	node.scaleXYZ = glm::vec3(20.0f, 1.0f, 20.0f);
+	node.positionXYZ = glm::vec3(0.0f, -0.5f, 0.0f);
+	node.materialHandle = m_wallMaterial;
+	node.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	AddSceneNode(node);
+
+	// Lamp base
+	node = SCENE_NODE();
+	node.meshShape = MESH_CYLINDER;
+	node.scaleXYZ = glm::vec3(1.5f, 0.2f, 1.5f);
+	node.positionXYZ = glm::vec3(5.0f, 0.0f, 0.0f);
+	node.materialHandle = m_graniteMaterial; // Using granite so it's not invisible white
+	node.color = glm::vec4(0.85f, 0.85f, 0.85f, 1.0f);
+	AddSceneNode(node);
+
+	// Lamp Neck
+	node = SCENE_NODE();
+	node.meshShape = MESH_CYLINDER;
+	node.scaleXYZ = glm::vec3(0.05f, 4.0f, 0.05f);
+	node.positionXYZ = glm::vec3(6.0f, 0.0f, 0.0f);
+	node.materialHandle = m_lampMaterial;
+	node.color = glm::vec4(0.85f, 0.85f, 0.85f, 1.0f);
+	AddSceneNode(node);
+
+	// Lamp Shade
+	node = SCENE_NODE();
+	node.meshShape = MESH_TAPERED_CYLINDER;
+	node.scaleXYZ = glm::vec3(1.2f, 1.5f, 1.2f);
+	node.XrotationDegrees = -45.0f;
+	node.positionXYZ = glm::vec3(5.5f, 3.8f, 0.0f);
+	node.materialHandle = m_lampMaterial;
+	node.color = glm::vec4(0.85f, 0.85f, 0.85f, 1.0f);
+	AddSceneNode(node);
+
+	// Lamp Bulb
+	node = SCENE_NODE();
+	node.meshShape = MESH_SPHERE;
+	node.scaleXYZ = glm::vec3(0.2f, 0.2f, 0.2f);
+	node.positionXYZ = glm::vec3(5.5f, 3.6f, 0.0f);
+	node.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f); // Bright Yellow
+	AddSceneNode(node);
+
+	// Lamp Joint
+	node = SCENE_NODE();
+	node.meshShape = MESH_CYLINDER;
+	node.scaleXYZ = glm::vec3(0.15f, 0.3f, 0.15f);
+	node.ZrotationDegrees = 90.0f;
+	node.positionXYZ = glm::vec3(6.0f, 4.0f, -0.2f);
+	node.materialHandle = m_goldMaterial;
+	node.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+	AddSceneNode(node);
+
+	// Clock
+	node = SCENE_NODE();
+	node.meshShape = MESH_CYLINDER;
+	node.scaleXYZ = glm::vec3(1.6f, 0.05f, 1.6f);
+	node.XrotationDegrees = 90.0f;
+	node.positionXYZ = glm::vec3(-2.0f, 7.0f, -4.95f);
+	node.materialHandle = m_marbleMaterial;
+	node.color = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
+	AddSceneNode(node);
+
+	// Clock Face
+	node = SCENE_NODE();
+	node.meshShape = MESH_CYLINDER;
+	node.scaleXYZ = glm::vec3(1.5f, 0.1f, 1.5f);
+	node.XrotationDegrees = 90.0f;
+	node.positionXYZ = glm::vec3(-2.0f, 7.0f, -4.9f);
+	node.textureHandle = m_woodTexture;
+	node.materialHandle = m_marbleMaterial;
+	AddSceneNode(node);
+
+	// Pot
+	node = SCENE_NODE();
+	node.meshShape = MESH_SPHERE;
+	node.scaleXYZ = glm::vec3(1.2f, 1.0f, 1.2f);
+	node.positionXYZ = glm::vec3(2.0f, 0.5f, 0.0f);
+	node.materialHandle = m_graniteMaterial;
+	node.color = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f);
+	AddSceneNode(node);
+
+	// Leaves
+	int leafCount = 10;
+	for (int i = 0; i < leafCount; i++) {
+		float randomHeight = 1.5f + (static_cast<float>(i % 3) * 0.2f);
+
+		float yRotation = i * (360.0f / leafCount);
+		float xTilt = 20.0f + (i * 3.0f);
+		float zLean = (i % 2 == 0) ? 5.0f : -5.0f;
+
+		node = SCENE_NODE();
+		node.meshShape = MESH_TAPERED_CYLINDER;
+		node.scaleXYZ = glm::vec3(0.12f, randomHeight, 0.4f);
+		node.XrotationDegrees = xTilt;
+		node.YrotationDegrees = yRotation;
+		node.ZrotationDegrees = zLean;
+		node.positionXYZ = glm::vec3(2.0f, 1.3f, 0.0f);
+		node.textureHandle = m_leafTexture;
+		node.materialHandle = m_graniteMaterial;
+		AddSceneNode(node);
+	}
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by
+ *  iterating the retained scene nodes and drawing each one
+ *  with its precomputed model matrix.
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// this frame renders the scene as it stands now - any later
+	// change sets the flag again
+	m_bSceneChanged = false;
+
+	SetupSceneLights();
+
+	// recompute the model matrices of any nodes that moved
+	// since the last frame - static nodes pay nothing here
+	UpdateSceneNodes();
+
+	// re-sort the queue only when the scene has changed
+	if (m_bRenderQueueDirty == true)
+	{
+		BuildRenderQueue();
+		m_occlusionCuller->Resize((int)m_sceneNodes.size());
+	}
+
+	// pick up any occlusion query results the GPU has finished
+	// - queries still in flight keep their node's last answer
+	m_occlusionCuller->CollectResults();
+
+	// extract one view frustum per viewport from the camera
+	// matrices the view manager computed for this frame - the
+	// scene is traversed once against all of them, and a node
+	// is recorded when any viewport can see it
+	int viewportCount = ViewManager::GetViewportCount();
+	glm::vec4 frustumPlanes[ViewManager::MAX_VIEWPORTS][6];
+	for (int viewport = 0; viewport < viewportCount; viewport++)
+	{
+		ExtractFrustumPlanes(
+			ViewManager::GetProjectionMatrix(viewport) *
+			ViewManager::GetViewMatrix(viewport),
+			frustumPlanes[viewport]);
+	}
+
+	// the occlusion queries are issued against one camera's
+	// depth buffer, so their answers only hold when a single
+	// viewport is being rendered
+	bool bUseOcclusion = (viewportCount == 1);
+
+	// camera terms for the detail level selection - nodes whose
+	// bounding spheres project small pick one of the library's
+	// reduced tessellations; the shared record uses the
+	// operator viewport's camera
+	glm::vec3 viewPosition = ViewManager::GetViewPosition();
+	float projectionScaleY = ViewManager::GetProjectionMatrix()[1][1];
+
+	// the indirect path turns the whole visible queue into one
+	// command array and submits it with a single call - the
+	// cull and record work per node is independent, so it runs
+	// across the worker pool; each worker owns a disjoint slice
+	// of a frame-arena record array, which the GL thread walks
+	// in queue order and submits
+	if (m_bUseIndirectPath == true)
+	{
+		int queueCount = (int)m_renderQueue.size();
+		RECORDED_DRAW* recordedDraws =
+			FrameArena::Instance().AllocateArray<RECORDED_DRAW>(queueCount);
+		unsigned char* recordedFlags =
+			FrameArena::Instance().AllocateArray<unsigned char>(queueCount);
+
+		JobSystem::Instance().ParallelFor(
+			queueCount, 64,
+			[this, &frustumPlanes, viewportCount, bUseOcclusion,
+				viewPosition, projectionScaleY,
+				recordedDraws, recordedFlags](int rangeBegin, int rangeEnd, int threadIndex)
+			{
+				for (int queueIndex = rangeBegin; queueIndex < rangeEnd; queueIndex++)
+				{
+					int nodeIndex = m_renderQueue[queueIndex];
+					const SCENE_NODE& node = m_sceneNodes[nodeIndex];
+
+					if (SphereInAnyFrustum(frustumPlanes, viewportCount,
+						node.boundingCenter, node.boundingRadius) == false)
+					{
+						recordedFlags[queueIndex] = 0;
+						continue;
+					}
+
+					// skip nodes a query proved hidden behind the
+					// major occluders - those are never skipped
+					if ((bUseOcclusion == true) &&
+						(IsMajorOccluder(node) == false) &&
+						(m_occlusionCuller->IsOccluded(nodeIndex) == true))
+					{
+						recordedFlags[queueIndex] = 0;
+						continue;
+					}
+
+					RECORDED_DRAW recordedDraw;
+					m_meshLibrary->GetMeshRange(
+						(MeshLibrary::MESH_ID)node.meshShape,
+						SelectLodLevel(node.boundingCenter, node.boundingRadius,
+							viewPosition, projectionScaleY),
+						recordedDraw.indexCount,
+						recordedDraw.firstIndexByteOffset,
+						recordedDraw.baseVertex);
+					FillPerObjectData(node, recordedDraw.objectData);
+
+					recordedDraws[queueIndex] = recordedDraw;
+					recordedFlags[queueIndex] = 1;
+				}
+			});
+
+		// split the recorded draws into the two passes and order
+		// each by distance to the operator camera - front to back
+		// for the opaque pass, back to front for the transparent
+		// one; in split screen the overview shares the ordering,
+		// which blends correctly for the scene's few transparents
+		DRAW_ORDER* opaqueOrder =
+			FrameArena::Instance().AllocateArray<DRAW_ORDER>(queueCount);
+		DRAW_ORDER* transparentOrder =
+			FrameArena::Instance().AllocateArray<DRAW_ORDER>(queueCount);
+		int opaqueCount = 0;
+		int transparentCount = 0;
+		for (int queueIndex = 0; queueIndex < queueCount; queueIndex++)
+		{
+			if (recordedFlags[queueIndex] == 0)
+			{
+				continue;
+			}
+
+			const SCENE_NODE& node = m_sceneNodes[m_renderQueue[queueIndex]];
+			DRAW_ORDER drawOrder;
+			drawOrder.distance = glm::length(node.boundingCenter - viewPosition);
+			drawOrder.queueIndex = queueIndex;
+
+			if (IsNodeTransparent(node) == true)
+			{
+				transparentOrder[transparentCount] = drawOrder;
+				transparentCount++;
+			}
+			else
+			{
+				opaqueOrder[opaqueCount] = drawOrder;
+				opaqueCount++;
+			}
+		}
+		std::sort(opaqueOrder, opaqueOrder + opaqueCount,
+			[](const DRAW_ORDER& left, const DRAW_ORDER& right)
+			{
+				return(left.distance < right.distance);
+			});
+		std::sort(transparentOrder, transparentOrder + transparentCount,
+			[](const DRAW_ORDER& left, const DRAW_ORDER& right)
+			{
+				return(left.distance > right.distance);
+			});
+
+		// opaque pass - blending stays disabled so every draw is
+		// pure depth-tested fill, and the near-to-far order lets
+		// early-Z reject the fragments the closer draws covered;
+		// the shared record is submitted once per viewport with
+		// only the camera state rebound in between
+		m_indirectRenderer->BeginFrame();
+		for (int draw = 0; draw < opaqueCount; draw++)
+		{
+			const RECORDED_DRAW& recordedDraw =
+				recordedDraws[opaqueOrder[draw].queueIndex];
+			m_indirectRenderer->AddDraw(
+				recordedDraw.indexCount,
+				recordedDraw.firstIndexByteOffset,
+				recordedDraw.baseVertex,
+				recordedDraw.objectData);
+		}
+		m_indirectRenderer->SubmitFrame(m_meshLibrary, viewportCount,
+			[](int viewportIndex)
+			{
+				ViewManager::ApplyViewport(viewportIndex);
+			});
+
+		// transparent pass - blended over the finished opaque
+		// image, reading depth but not writing it so transparent
+		// surfaces never mask each other; skipped entirely when
+		// the frame has no transparent node
+		if (transparentCount > 0)
+		{
+			glEnable(GL_BLEND);
+			glDepthMask(GL_FALSE);
+
+			m_indirectRenderer->BeginFrame();
+			for (int draw = 0; draw < transparentCount; draw++)
+			{
+				const RECORDED_DRAW& recordedDraw =
+					recordedDraws[transparentOrder[draw].queueIndex];
+				m_indirectRenderer->AddDraw(
+					recordedDraw.indexCount,
+					recordedDraw.firstIndexByteOffset,
+					recordedDraw.baseVertex,
+					recordedDraw.objectData);
+			}
+			m_indirectRenderer->SubmitFrame(m_meshLibrary, viewportCount,
+				[](int viewportIndex)
+				{
+					ViewManager::ApplyViewport(viewportIndex);
+				});
+
+			glDepthMask(GL_TRUE);
+			glDisable(GL_BLEND);
+		}
+
+		// with the frame's depth buffer complete, re-test the
+		// in-frustum bounding boxes for the next frame
+		if (bUseOcclusion == true)
+		{
+			RunOcclusionProxyPass(frustumPlanes[0], viewPosition);
+		}
+		return;
+	}
+
+	// shader state carried across the sorted draws - start
+	// with values no node can hold so the first draw of each
+	// group sets up its full state; GL state persists across
+	// the viewports, so the carry does too; the uniform carry
+	// is per program, so a permutation switch resets it
+	int lastVariant = -1;
+	int lastTextureHandle = -2;
+	int lastMaterialHandle = -2;
+	glm::vec4 lastColor = glm::vec4(-1.0f);
+
+	// the scene state prepared above is shared - each viewport
+	// only rebinds the camera and replays the draws its own
+	// frustum keeps
+	for (int viewport = 0; viewport < viewportCount; viewport++)
+	{
+		ViewManager::ApplyViewport(viewport);
+
+		// this viewport's camera terms for the detail selection
+		glm::vec3 viewportViewPosition = ViewManager::GetViewPosition(viewport);
+		float viewportProjectionScaleY = ViewManager::GetProjectionMatrix(viewport)[1][1];
+
+		// cull this viewport's nodes and split the survivors into
+		// the two ordered passes - front to back for the opaque
+		// draws, back to front for the transparent ones
+		int queueCount = (int)m_renderQueue.size();
+		DRAW_ORDER* opaqueOrder =
+			FrameArena::Instance().AllocateArray<DRAW_ORDER>(queueCount);
+		DRAW_ORDER* transparentOrder =
+			FrameArena::Instance().AllocateArray<DRAW_ORDER>(queueCount);
+		int opaqueCount = 0;
+		int transparentCount = 0;
+		for (int queueIndex = 0; queueIndex < queueCount; queueIndex++)
+		{
+			int nodeIndex = m_renderQueue[queueIndex];
+			const SCENE_NODE& node = m_sceneNodes[nodeIndex];
+
+			if (SphereInFrustum(frustumPlanes[viewport], node.boundingCenter, node.boundingRadius) == false)
+			{
+				continue;
+			}
+
+			// skip nodes a query proved hidden behind the major
+			// occluders - those are never skipped
+			if ((bUseOcclusion == true) &&
+				(IsMajorOccluder(node) == false) &&
+				(m_occlusionCuller->IsOccluded(nodeIndex) == true))
+			{
+				continue;
+			}
+
+			DRAW_ORDER drawOrder;
+			drawOrder.distance = glm::length(node.boundingCenter - viewportViewPosition);
+			drawOrder.queueIndex = queueIndex;
+			drawOrder.variant = ShaderVariants::VariantIndex(node.textureHandle >= 0, true);
+
+			if (IsNodeTransparent(node) == true)
+			{
+				transparentOrder[transparentCount] = drawOrder;
+				transparentCount++;
+			}
+			else
+			{
+				opaqueOrder[opaqueCount] = drawOrder;
+				opaqueCount++;
+			}
+		}
+		// the opaque pass buckets by shader permutation first so
+		// program switches stay at one per bucket, and orders by
+		// distance within the bucket for the early-Z win; the
+		// transparent order is purely distance, since the blend
+		// only composes correctly strictly back to front
+		std::sort(opaqueOrder, opaqueOrder + opaqueCount,
+			[](const DRAW_ORDER& left, const DRAW_ORDER& right)
+			{
+				if (left.variant != right.variant)
+					return(left.variant < right.variant);
+				return(left.distance < right.distance);
+			});
+		std::sort(transparentOrder, transparentOrder + transparentCount,
+			[](const DRAW_ORDER& left, const DRAW_ORDER& right)
+			{
+				return(left.distance > right.distance);
+			});
+
+		// draws one ordered pass - the shader state carry lives
+		// outside, so a texture both passes share is only bound
+		// once
+		auto drawOrderedNodes = [&](const DRAW_ORDER* drawOrder, int drawCount)
+		{
+			for (int draw = 0; draw < drawCount; draw++)
+			{
+				const SCENE_NODE& node =
+					m_sceneNodes[m_renderQueue[drawOrder[draw].queueIndex]];
+
+				// activate the specialized program for this draw's
+				// permutation - the uniform carry belongs to the
+				// previous program, so it starts over
+				if (drawOrder[draw].variant != lastVariant)
+				{
+					ShaderVariants::Instance().Use(node.textureHandle >= 0, true);
+					lastVariant = drawOrder[draw].variant;
+					lastTextureHandle = -2;
+					lastMaterialHandle = -2;
+					lastColor = glm::vec4(-1.0f);
+				}
+
+				UniformCache::Instance().setMat4Value(g_ModelName, node.modelMatrix);
+
+				if (node.textureHandle >= 0)
+				{
+					if (node.textureHandle != lastTextureHandle)
+					{
+						SetShaderTexture(node.textureHandle);
+						lastTextureHandle = node.textureHandle;
+					}
+					SetTextureUVScale(node.uvScale.x, node.uvScale.y);
+				}
+				else
+				{
+					if ((lastTextureHandle != -1) || (node.color != lastColor))
+					{
+						SetShaderColor(node.color.r, node.color.g, node.color.b, node.color.a);
+						lastTextureHandle = -1;
+						lastColor = node.color;
+					}
+				}
+
+				if ((node.materialHandle >= 0) && (node.materialHandle != lastMaterialHandle))
+				{
+					SetShaderMaterial(node.materialHandle);
+					lastMaterialHandle = node.materialHandle;
+				}
+
+				DrawMesh(node.meshShape,
+					SelectLodLevel(node.boundingCenter, node.boundingRadius,
+						viewportViewPosition, viewportProjectionScaleY));
+			}
+		};
+
+		// every shape lives in the library's shared buffers, so
+		// one vertex array bind covers the whole sorted queue
+		m_meshLibrary->BindMeshes();
+
+		// opaque pass - blending stays disabled, and the near-to-
+		// far order lets early-Z reject covered fragments
+		drawOrderedNodes(opaqueOrder, opaqueCount);
+
+		m_meshLibrary->UnbindMeshes();
+
+		// submit the instanced batches - N copies of a repeated
+		// shape cost one draw call each
+		for (size_t batchIndex = 0; batchIndex < m_instancedBatches.size(); batchIndex++)
+		{
+			const INSTANCED_BATCH& batch = m_instancedBatches[batchIndex];
+
+			// stage the visible instance matrices in the frame arena
+			glm::mat4* instanceMatrices = FrameArena::Instance().AllocateArray<glm::mat4>(
+				batch.nodeIndexes.size());
+			int instanceCount = 0;
+			for (size_t instance = 0; instance < batch.nodeIndexes.size(); instance++)
+			{
+				const SCENE_NODE& instanceNode = m_sceneNodes[batch.nodeIndexes[instance]];
+
+				// the visibility pass applies per instance, so an
+				// off-screen copy costs nothing
+				if (SphereInFrustum(frustumPlanes[viewport], instanceNode.boundingCenter, instanceNode.boundingRadius) == false)
+				{
+					continue;
+				}
+
+				instanceMatrices[instanceCount] = instanceNode.modelMatrix;
+				instanceCount++;
+			}
+
+			if (instanceCount == 0)
+			{
+				continue;
+			}
+
+			if ((batch.materialHandle >= 0) &&
+				(batch.materialHandle < (int)m_objectMaterials.size()))
+			{
+				const OBJECT_MATERIAL& material = m_objectMaterials[batch.materialHandle];
+				m_instancedMeshes->SetMaterial(
+					material.ambientColor,
+					material.ambientStrength,
+					material.diffuseColor,
+					material.specularColor,
+					material.shininess);
+			}
+			m_instancedMeshes->SetTexture(batch.textureHandle);
+			m_instancedMeshes->SetColor(batch.color);
+
+			m_instancedMeshes->DrawTaperedCylinderMeshInstanced(
+				instanceMatrices,
+				instanceCount);
+		}
+
+		// transparent pass - last in the viewport so it blends
+		// over everything opaque, including the instanced
+		// batches; depth is read but not written so transparent
+		// surfaces never mask each other
+		if (transparentCount > 0)
+		{
+			glEnable(GL_BLEND);
+			glDepthMask(GL_FALSE);
+
+			m_meshLibrary->BindMeshes();
+			drawOrderedNodes(transparentOrder, transparentCount);
+			m_meshLibrary->UnbindMeshes();
+
+			glDepthMask(GL_TRUE);
+			glDisable(GL_BLEND);
+		}
+	}
+
+	// with the frame's depth buffer complete, re-test the
+	// in-frustum bounding boxes for the next frame
+	if (bUseOcclusion == true)
+	{
+		RunOcclusionProxyPass(frustumPlanes[0], viewPosition);
+	}
+}
+
+/***********************************************************
+ *  RunOcclusionProxyPass()
+ *
+ *  This method rasterizes the bounding box of every
+ *  in-frustum node inside an occlusion query, against the
+ *  depth buffer the finished frame left behind - skipped
+ *  nodes are re-tested too, so they reappear the frame
+ *  after they stop being occluded.
+ ***********************************************************/
+void SceneManager::RunOcclusionProxyPass(
+	const glm::vec4 frustumPlanes[6],
+	glm::vec3 viewPosition)
+{
+	if (m_occlusionCuller->IsEnabled() == false)
+	{
+		return;
+	}
+
+	m_occlusionCuller->BeginProxyPass();
+
+	for (size_t queueIndex = 0; queueIndex < m_renderQueue.size(); queueIndex++)
+	{
+		int nodeIndex = m_renderQueue[queueIndex];
+		const SCENE_NODE& node = m_sceneNodes[nodeIndex];
+
+		// the major occluders are never skipped, so they need
+		// no query of their own
+		if (IsMajorOccluder(node) == true)
+		{
+			continue;
+		}
+
+		if (SphereInFrustum(frustumPlanes, node.boundingCenter, node.boundingRadius) == false)
+		{
+			continue;
+		}
+
+		m_occlusionCuller->TestNode(
+			nodeIndex, node.boundingCenter, node.boundingRadius, viewPosition);
+	}
+
+	m_occlusionCuller->EndProxyPass();
+}
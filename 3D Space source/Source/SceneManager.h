@@ -9,25 +9,29 @@
 
 #pragma once
 
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "MeshLibrary.h"
+#include "IndirectRenderer.h"
+#include "InstancedMeshes.h"
+#include "OcclusionCuller.h"
+#include "TextureArray.h"
+#include "TransformKernel.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <glm/glm.hpp>
 
 class SceneManager
 {
 public:
-    SceneManager(ShaderManager* pShaderManager);
+    SceneManager();
     ~SceneManager();
 
     // Structures used for scene data
-    struct TEXTURE_INFO
-    {
-        std::string tag;
-        uint32_t ID;
-    };
-
     struct OBJECT_MATERIAL
     {
         std::string tag;
@@ -38,6 +42,45 @@ public:
         float shininess;
     };
 
+    // the basic mesh shapes that a scene node can reference
+    enum MESH_SHAPE
+    {
+        MESH_PLANE,
+        MESH_BOX,
+        MESH_CONE,
+        MESH_PRISM,
+        MESH_PYRAMID3,
+        MESH_SPHERE,
+        MESH_TORUS,
+        MESH_TAPERED_CYLINDER,
+        MESH_CYLINDER
+    };
+
+    // a retained scene object - the transform components are
+    // kept so nodes can still be moved at runtime, while the
+    // model matrix is only recomputed when the dirty flag is
+    // set by a transform change
+    struct SCENE_NODE
+    {
+        MESH_SHAPE meshShape = MESH_BOX;
+        glm::vec3 scaleXYZ = glm::vec3(1.0f);
+        float XrotationDegrees = 0.0f;
+        float YrotationDegrees = 0.0f;
+        float ZrotationDegrees = 0.0f;
+        glm::vec3 positionXYZ = glm::vec3(0.0f);
+        glm::mat4 modelMatrix = glm::mat4(1.0f);
+        int materialHandle = -1;
+        // -1 draws the node with the solid color instead
+        int textureHandle = -1;
+        glm::vec2 uvScale = glm::vec2(1.0f);
+        glm::vec4 color = glm::vec4(1.0f);
+        // world-space bounding sphere, refreshed along with
+        // the model matrix and used by the visibility pass
+        glm::vec3 boundingCenter = glm::vec3(0.0f);
+        float boundingRadius = 1.0f;
+        bool bDirty = true;
+    };
+
     // Public methods for managing the scene
     void PrepareScene();
     void RenderScene();
@@ -45,21 +88,217 @@ public:
     void LoadSceneMaterials();
     void LoadSceneTextures();
 
+    // upload any texture decodes the worker threads have
+    // finished - called once per frame from the render loop
+    void UpdateAsyncTextureLoads();
+
+    // true when the scene has changed since the last rendered
+    // frame - nodes added or moved, or texture uploads still
+    // outstanding; the render-on-change mode redraws only when
+    // this or the view reports a change
+    bool IsSceneDirty() const;
+
+    // 64-bit FNV-1a hash over the tag characters - the registries
+    // are keyed by this hash so lookups never compare strings
+    static uint64_t HashTag(std::string_view tag);
+
+    // resolve a tag into an integer handle once, outside the
+    // render loop - the handle overloads of the Set* methods
+    // below are what the per-frame draw path should use; the
+    // tag is a view so no lookup ever copies a string
+    int GetTextureHandle(std::string_view tag) const;
+    int GetMaterialHandle(std::string_view tag) const;
+
+    // add a node to the retained scene and return its index
+    int AddSceneNode(const SCENE_NODE& node);
+    // update the transform of an existing node - this marks the
+    // node dirty so its model matrix is recomputed before the
+    // next frame is drawn
+    void SetNodeTransform(
+        int nodeIndex,
+        glm::vec3 scaleXYZ,
+        float XrotationDegrees,
+        float YrotationDegrees,
+        float ZrotationDegrees,
+        glm::vec3 positionXYZ);
+
 private:
     // Member variables
-    ShaderManager* m_pShaderManager;
-    ShapeMeshes* m_basicMeshes;
-    int m_loadedTextures = 0;
-    TEXTURE_INFO m_textureIDs[16];
+    MeshLibrary* m_meshLibrary;
+    // every scene texture lives in one array texture bound
+    // once - a texture handle is a layer index into it
+    TextureArray* m_textureArray;
     std::vector<OBJECT_MATERIAL> m_objectMaterials;
 
+    // registries mapping hashed tags to texture layers and
+    // material indexes, built as the scene assets are loaded
+    std::unordered_map<uint64_t, int> m_textureSlotMap;
+    std::unordered_map<uint64_t, int> m_materialMap;
+
+    // whether each texture layer's decoded image carried an
+    // alpha channel, indexed by texture handle - nodes using
+    // an alpha texture draw in the blended transparent pass
+    std::vector<bool> m_textureLayerHasAlpha;
+
+    // handles resolved once in PrepareScene() so the render
+    // loop passes integers instead of tag strings
+    int m_wallTexture = -1;
+    int m_woodTexture = -1;
+    int m_leafTexture = -1;
+    int m_wallMaterial = -1;
+    int m_graniteMaterial = -1;
+    int m_lampMaterial = -1;
+    int m_goldMaterial = -1;
+    int m_marbleMaterial = -1;
+
+    // the retained scene - a flat contiguous array of nodes
+    // that RenderScene() iterates every frame
+    std::vector<SCENE_NODE> m_sceneNodes;
+
+    // set whenever the scene changes and cleared when a frame
+    // renders it - backs IsSceneDirty()
+    bool m_bSceneChanged = true;
+
+    // the render queue - node indexes sorted by shader state
+    // so draws sharing a texture/material run back to back,
+    // rebuilt only when nodes are added to the scene
+    std::vector<int> m_renderQueue;
+    bool m_bRenderQueueDirty = true;
+
+    // a group of repeated shapes that differ only by model
+    // matrix, submitted with one instanced draw call
+    struct INSTANCED_BATCH
+    {
+        MESH_SHAPE meshShape = MESH_TAPERED_CYLINDER;
+        int textureHandle = -1;
+        int materialHandle = -1;
+        glm::vec4 color = glm::vec4(1.0f);
+        std::vector<int> nodeIndexes;
+    };
+    std::vector<INSTANCED_BATCH> m_instancedBatches;
+
+    // instanced rendering backend for the repeated shapes -
+    // the per-instance matrices are staged in the frame arena
+    InstancedMeshes* m_instancedMeshes;
+
+    // staging for the dirty-node transform batch - the dirty
+    // node indexes, their transform components in SoA form for
+    // the SIMD kernel, and the composed matrices, all reused
+    // every frame to avoid reallocations
+    std::vector<int> m_dirtyNodeScratch;
+    TransformKernel::TRANSFORM_SOA m_transformScratch;
+    std::vector<glm::mat4> m_dirtyMatrixScratch;
+
+    // multi-draw-indirect backend - the whole visible scene
+    // becomes one submission when the context is GL 4.6
+    IndirectRenderer* m_indirectRenderer;
+    bool m_bUseIndirectPath = false;
+
+    // hardware occlusion query backend - nodes hidden behind
+    // the large occluders are skipped a frame after a query
+    // proves them occluded
+    OcclusionCuller* m_occlusionCuller;
+
+    // one fully recorded indirect draw - the worker threads
+    // fill these into a frame-arena array which the GL thread
+    // walks in queue order and submits
+    struct RECORDED_DRAW
+    {
+        GLsizei indexCount = 0;
+        size_t firstIndexByteOffset = 0;
+        GLint baseVertex = 0;
+        IndirectRenderer::PER_OBJECT_DATA objectData;
+    };
+
+    // a texture file waiting to be decoded by a worker thread
+    struct TEXTURE_LOAD_TASK
+    {
+        std::string filename;
+        int textureSlot = -1;
+    };
+
+    // a finished decode waiting for its GL upload on the main
+    // thread - the worker resamples the pixels and builds the
+    // mip pyramid in the background, so the upload is pure
+    // transfer; the pyramid is empty when the decode failed
+    struct TEXTURE_LOAD_RESULT
+    {
+        std::string filename;
+        int textureSlot = -1;
+        int width = 0;
+        int height = 0;
+        int colorChannels = 0;
+        std::vector<std::vector<unsigned char>> mipPixels;
+    };
+
+    // the async texture pipeline - worker threads pull tasks,
+    // decode with stb_image, and push results for the main
+    // thread to upload in UpdateAsyncTextureLoads()
+    std::vector<TEXTURE_LOAD_TASK> m_textureLoadTasks;
+    std::atomic<int> m_nextTextureTask{ 0 };
+    std::vector<std::thread> m_textureWorkers;
+    std::mutex m_textureResultsMutex;
+    std::vector<TEXTURE_LOAD_RESULT> m_textureResults;
+    int m_pendingTextureLoads = 0;
+
     // Internal helper methods
     bool CreateGLTexture(const char* filename, std::string tag);
+    // load a precompressed DDS texture (BC1/BC2/BC3), unpacked
+    // on the CPU into its layer of the shared texture array
+    bool LoadDDSTexture(const char* filename, std::string tag);
+    // true when the filename ends with the .dds extension
+    static bool IsDDSFile(const char* filename);
+    // register a placeholder layer for the tag and queue the
+    // file for decoding on the worker pool
+    void QueueTextureLoad(const char* filename, std::string tag);
     void BindGLTextures();
-    void DestroyGLTextures();
-    int FindTextureID(std::string tag);
-    int FindTextureSlot(std::string tag);
-    bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+    // record whether a texture layer carries an alpha channel
+    void MarkTextureAlpha(int layer, bool bHasAlpha);
+    // true when a node must draw in the blended back-to-front
+    // pass - its texture has alpha or its solid color does
+    bool IsNodeTransparent(const SCENE_NODE& node) const;
+    int FindTextureID(std::string_view tag);
+    int FindTextureSlot(std::string_view tag);
+    // look up a previously defined material by tag - returns a
+    // pointer into the registry so nothing is copied per call
+    const OBJECT_MATERIAL* FindMaterial(std::string_view tag) const;
+
+    // build the retained scene node array - called once from
+    // PrepareScene() after the assets have been registered;
+    // loads the scene description file when one is present and
+    // falls back to the built-in placements otherwise
+    void BuildScene();
+    // the built-in scene placements, used when no scene
+    // description file could be loaded
+    void BuildDefaultScene();
+    // recompute the model matrices of any nodes marked dirty
+    void UpdateSceneNodes();
+    // rebuild the state-sorted render queue over the nodes
+    void BuildRenderQueue();
+    // rasterize the in-frustum bounding boxes inside occlusion
+    // queries, after the scene has filled the depth buffer
+    void RunOcclusionProxyPass(
+        const glm::vec4 frustumPlanes[6],
+        glm::vec3 viewPosition);
+    // compose a model matrix from the passed in transform values
+    static glm::mat4 ComputeModelMatrix(
+        glm::vec3 scaleXYZ,
+        float XrotationDegrees,
+        float YrotationDegrees,
+        float ZrotationDegrees,
+        glm::vec3 positionXYZ);
+    // issue the draw call for the passed in mesh shape at
+    // the passed in detail level
+    void DrawMesh(MESH_SHAPE meshShape, int lodLevel = 0);
+    // fill one indirect per-object record from a scene node
+    void FillPerObjectData(
+        const SCENE_NODE& node,
+        IndirectRenderer::PER_OBJECT_DATA& objectData) const;
+    // conservative local-space bounding sphere for a shape
+    static void GetMeshLocalBounds(
+        MESH_SHAPE meshShape,
+        glm::vec3& localCenter,
+        float& localRadius);
 
     void SetTransformations(
         glm::vec3 scaleXYZ,
@@ -72,9 +311,11 @@ private:
         float redColorValue, float greenColorValue,
         float blueColorValue, float alphaValue);
 
-    void SetShaderTexture(std::string textureTag);
+    void SetShaderTexture(std::string_view textureTag);
+    void SetShaderTexture(int textureHandle);
     void SetTextureUVScale(float u, float v);
-    void SetShaderMaterial(std::string materialTag);
+    void SetShaderMaterial(std::string_view materialTag);
+    void SetShaderMaterial(int materialHandle);
     void SetCameraPosition(glm::vec3 cameraPosition) { m_cameraPosition = cameraPosition; }
     glm::vec3 m_cameraPosition; 
 };
\ No newline at end of file
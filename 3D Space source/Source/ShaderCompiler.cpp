@@ -0,0 +1,291 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercompiler.cpp
+// ============
+// compiles and links OpenGL shader programs from GLSL source strings,
+// used by every shader path in the application - linked programs are
+// persisted as driver binaries keyed by source and driver, so later
+// launches skip the GLSL compile entirely
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderCompiler.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// the cache file starts with this fixed header, followed by
+	// the driver's program binary blob
+	struct BINARY_CACHE_HEADER
+	{
+		GLenum binaryFormat = 0;
+		uint32_t binaryLength = 0;
+	};
+
+	/*******************************************************
+	 *  HashBytes()
+	 *
+	 *  This function folds a byte range into a running
+	 *  64-bit FNV-1a hash.
+	 *******************************************************/
+	uint64_t HashBytes(uint64_t hash, const char* bytes)
+	{
+		for (size_t i = 0; bytes[i] != '\0'; i++)
+		{
+			hash ^= (uint64_t)(unsigned char)bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return(hash);
+	}
+}
+
+/***********************************************************
+ *  CompileStage()
+ *
+ *  This method compiles a single shader stage from the
+ *  passed in source, logging the info log and returning 0
+ *  when compilation fails.
+ ***********************************************************/
+GLuint ShaderCompiler::CompileStage(GLenum stageType, const std::string& source)
+{
+	GLuint shaderID = glCreateShader(stageType);
+	const char* sourcePtr = source.c_str();
+
+	glShaderSource(shaderID, 1, &sourcePtr, NULL);
+	glCompileShader(shaderID);
+
+	GLint compileStatus = GL_FALSE;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compileStatus);
+	if (compileStatus == GL_FALSE)
+	{
+		GLint logLength = 0;
+		glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<char> infoLog(logLength + 1, '\0');
+		glGetShaderInfoLog(shaderID, logLength, NULL, infoLog.data());
+
+		std::cout << "Failed to compile shader stage:" << std::endl;
+		std::cout << infoLog.data() << std::endl;
+
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  HashProgram()
+ *
+ *  This method computes the 64-bit FNV-1a hash keying a
+ *  program's cache entry - the shader sources plus the
+ *  driver renderer and version strings, so a source edit or
+ *  a driver update invalidates the cached binary.
+ ***********************************************************/
+uint64_t ShaderCompiler::HashProgram(
+	const std::string& vertexSource,
+	const std::string& fragmentSource)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	hash = HashBytes(hash, vertexSource.c_str());
+	hash = HashBytes(hash, fragmentSource.c_str());
+
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* version = (const char*)glGetString(GL_VERSION);
+	hash = HashBytes(hash, (renderer != NULL) ? renderer : "");
+	hash = HashBytes(hash, (version != NULL) ? version : "");
+
+	return(hash);
+}
+
+/***********************************************************
+ *  CacheFilename()
+ *
+ *  This method returns the cache filename for a program
+ *  hash - a flat file beside the executable like the scene
+ *  cache and the perf report.
+ ***********************************************************/
+std::string ShaderCompiler::CacheFilename(uint64_t programHash)
+{
+	char filename[64];
+	snprintf(filename, sizeof(filename),
+		"shader_cache_%016llx.bin", (unsigned long long)programHash);
+	return(std::string(filename));
+}
+
+/***********************************************************
+ *  LoadCachedProgram()
+ *
+ *  This method loads a cached program binary and hands it
+ *  to the driver - returns 0 when no cache entry exists or
+ *  the driver rejects the blob, and the caller recompiles.
+ ***********************************************************/
+GLuint ShaderCompiler::LoadCachedProgram(uint64_t programHash)
+{
+	FILE* pFile = NULL;
+	std::string filename = CacheFilename(programHash);
+#if defined(_MSC_VER)
+	fopen_s(&pFile, filename.c_str(), "rb");
+#else
+	pFile = fopen(filename.c_str(), "rb");
+#endif
+	if (NULL == pFile)
+	{
+		return(0);
+	}
+
+	BINARY_CACHE_HEADER header;
+	if (fread(&header, sizeof(header), 1, pFile) != 1)
+	{
+		fclose(pFile);
+		return(0);
+	}
+
+	std::vector<unsigned char> binary(header.binaryLength);
+	size_t bytesRead = fread(binary.data(), 1, header.binaryLength, pFile);
+	fclose(pFile);
+
+	if (bytesRead != (size_t)header.binaryLength)
+	{
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, header.binaryFormat,
+		binary.data(), (GLsizei)header.binaryLength);
+
+	// the driver is free to reject a binary it no longer
+	// understands - fall back to a fresh compile then
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == GL_FALSE)
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	std::cout << "INFO: Loaded shader program from cache "
+		<< filename << std::endl;
+
+	return(programID);
+}
+
+/***********************************************************
+ *  SaveCachedProgram()
+ *
+ *  This method persists a linked program's driver binary so
+ *  the next launch skips the GLSL compile.
+ ***********************************************************/
+void ShaderCompiler::SaveCachedProgram(uint64_t programHash, GLuint programID)
+{
+	// nothing to persist when the driver exposes no binary
+	// formats
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	if (formatCount <= 0)
+	{
+		return;
+	}
+
+	GLint binaryLength = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		return;
+	}
+
+	std::vector<unsigned char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(programID, binaryLength, NULL, &binaryFormat, binary.data());
+
+	FILE* pFile = NULL;
+	std::string filename = CacheFilename(programHash);
+#if defined(_MSC_VER)
+	fopen_s(&pFile, filename.c_str(), "wb");
+#else
+	pFile = fopen(filename.c_str(), "wb");
+#endif
+	if (NULL == pFile)
+	{
+		return;
+	}
+
+	BINARY_CACHE_HEADER header;
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = (uint32_t)binaryLength;
+
+	fwrite(&header, sizeof(header), 1, pFile);
+	fwrite(binary.data(), 1, binary.size(), pFile);
+	fclose(pFile);
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method compiles and links a shader program from the
+ *  passed in vertex and fragment source, logging the info
+ *  log and returning 0 when linking fails - a cached driver
+ *  binary is used instead when one matches the source and
+ *  driver, which skips the GLSL compile entirely.
+ ***********************************************************/
+GLuint ShaderCompiler::CompileProgram(
+	const std::string& vertexSource,
+	const std::string& fragmentSource)
+{
+	uint64_t programHash = HashProgram(vertexSource, fragmentSource);
+
+	GLuint cachedProgramID = LoadCachedProgram(programHash);
+	if (cachedProgramID != 0)
+	{
+		return(cachedProgramID);
+	}
+
+	GLuint vertexShaderID = CompileStage(GL_VERTEX_SHADER, vertexSource);
+	if (vertexShaderID == 0)
+	{
+		return(0);
+	}
+
+	GLuint fragmentShaderID = CompileStage(GL_FRAGMENT_SHADER, fragmentSource);
+	if (fragmentShaderID == 0)
+	{
+		glDeleteShader(vertexShaderID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, vertexShaderID);
+	glAttachShader(programID, fragmentShaderID);
+	// ask the driver to keep a retrievable binary around - must
+	// be set before the link
+	glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(programID);
+
+	// the stage objects are no longer needed once linked
+	glDeleteShader(vertexShaderID);
+	glDeleteShader(fragmentShaderID);
+
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == GL_FALSE)
+	{
+		GLint logLength = 0;
+		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<char> infoLog(logLength + 1, '\0');
+		glGetProgramInfoLog(programID, logLength, NULL, infoLog.data());
+
+		std::cout << "Failed to link shader program:" << std::endl;
+		std::cout << infoLog.data() << std::endl;
+
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	// persist the linked binary so the next launch skips this
+	// whole method
+	SaveCachedProgram(programHash, programID);
+
+	return(programID);
+}
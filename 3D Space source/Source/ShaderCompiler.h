@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercompiler.h
+// ============
+// compiles and links OpenGL shader programs from GLSL source strings,
+// used by every shader path in the application - linked programs are
+// persisted as driver binaries keyed by source and driver, so later
+// launches skip the GLSL compile entirely
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+
+class ShaderCompiler
+{
+public:
+	// compile and link a program from the passed in vertex and
+	// fragment shader source - returns 0 and logs the compile
+	// or link errors to the console on failure; the linked
+	// binary is cached on disk and reloaded on later launches
+	// as long as the source and driver have not changed
+	static GLuint CompileProgram(
+		const std::string& vertexSource,
+		const std::string& fragmentSource);
+
+private:
+	// compile a single shader stage, returning 0 on failure
+	static GLuint CompileStage(GLenum stageType, const std::string& source);
+
+	// 64-bit FNV-1a hash over the shader sources plus the
+	// driver renderer and version strings - a driver update
+	// invalidates every cached binary
+	static uint64_t HashProgram(
+		const std::string& vertexSource,
+		const std::string& fragmentSource);
+
+	// the cache filename for a program hash
+	static std::string CacheFilename(uint64_t programHash);
+
+	// load a cached program binary, returning 0 when no usable
+	// cache entry exists
+	static GLuint LoadCachedProgram(uint64_t programHash);
+
+	// persist a linked program's binary for the next launch
+	static void SaveCachedProgram(uint64_t programHash, GLuint programID);
+};
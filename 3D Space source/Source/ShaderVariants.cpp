@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.cpp
+// ============
+// compiles the specialized permutations of the shared scene shader -
+// textured/untextured crossed with lit/unlit - so no draw ever pays a
+// per-pixel branch on bUseTexture/bUseLighting or the per-draw uniform
+// traffic that drove those flags
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderVariants.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "ShaderCompiler.h"
+#include "UniformCache.h"
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared instance that is
+ *  used by all of the scene rendering code.
+ ***********************************************************/
+ShaderVariants& ShaderVariants::Instance()
+{
+	static ShaderVariants instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  VariantIndex()
+ *
+ *  This method returns the permutation index for the passed
+ *  in draw state - the low bit selects textured sampling and
+ *  the high bit the lighting rig.
+ ***********************************************************/
+int ShaderVariants::VariantIndex(bool bTextured, bool bLit)
+{
+	return((bTextured ? 1 : 0) | (bLit ? 2 : 0));
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method loads the shared GLSL sources and compiles
+ *  one specialized program per permutation - the feature
+ *  defines are injected ahead of the fragment source, so the
+ *  driver folds the old runtime branches away entirely.
+ ***********************************************************/
+bool ShaderVariants::Create(const char* vertexPath, const char* fragmentPath)
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+
+	if ((ReadSourceFile(vertexPath, vertexSource) == false) ||
+		(ReadSourceFile(fragmentPath, fragmentSource) == false))
+	{
+		return(false);
+	}
+
+	// the permutations share the vertex stage source unchanged -
+	// only the fragment stage tests the feature flags; each
+	// permutation still lands in its own slot of the program
+	// binary cache, since the fragment sources differ
+	for (int variant = 0; variant < VARIANT_COUNT; variant++)
+	{
+		bool bTextured = ((variant & 1) != 0);
+		bool bLit = ((variant & 2) != 0);
+
+		m_programIDs[variant] = ShaderCompiler::CompileProgram(
+			vertexSource,
+			InjectDefines(fragmentSource, bTextured, bLit));
+		if (m_programIDs[variant] == 0)
+		{
+			std::cout << "WARNING: Could not compile shader permutation "
+				<< variant << std::endl;
+			return(false);
+		}
+	}
+
+	std::cout << "INFO: Compiled " << VARIANT_COUNT
+		<< " specialized shader permutations" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Use()
+ *
+ *  This method activates the program of the permutation the
+ *  passed in draw state needs and points the uniform cache
+ *  at it - nothing happens when the permutation is already
+ *  the active one.
+ ***********************************************************/
+void ShaderVariants::Use(bool bTextured, bool bLit)
+{
+	int variant = VariantIndex(bTextured, bLit);
+	if (variant == m_activeVariant)
+	{
+		return;
+	}
+
+	glUseProgram(m_programIDs[variant]);
+	UniformCache::Instance().SetActiveProgram(m_programIDs[variant]);
+	m_activeVariant = variant;
+}
+
+/***********************************************************
+ *  ReadSourceFile()
+ *
+ *  This method reads the passed in GLSL source file into a
+ *  string, returning false when the file cannot be opened.
+ ***********************************************************/
+bool ShaderVariants::ReadSourceFile(const char* filePath, std::string& source)
+{
+	std::ifstream sourceFile(filePath);
+	if (sourceFile.is_open() == false)
+	{
+		std::cout << "WARNING: Could not open shader source file:"
+			<< filePath << std::endl;
+		return(false);
+	}
+
+	std::stringstream sourceStream;
+	sourceStream << sourceFile.rdbuf();
+	source = sourceStream.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  InjectDefines()
+ *
+ *  This method returns the passed in source with the two
+ *  permutation defines inserted directly after its #version
+ *  directive, where the preprocessor requires them to land.
+ ***********************************************************/
+std::string ShaderVariants::InjectDefines(
+	const std::string& source,
+	bool bTextured,
+	bool bLit)
+{
+	std::string defines;
+	defines += "#define USE_TEXTURE ";
+	defines += (bTextured ? "1\n" : "0\n");
+	defines += "#define USE_LIGHTING ";
+	defines += (bLit ? "1\n" : "0\n");
+
+	size_t versionStart = source.find("#version");
+	if (versionStart == std::string::npos)
+	{
+		return(defines + source);
+	}
+
+	size_t versionLineEnd = source.find('\n', versionStart);
+	if (versionLineEnd == std::string::npos)
+	{
+		return(source + "\n" + defines);
+	}
+
+	return(source.substr(0, versionLineEnd + 1) +
+		defines +
+		source.substr(versionLineEnd + 1));
+}
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.h
+// ============
+// compiles the specialized permutations of the shared scene shader -
+// textured/untextured crossed with lit/unlit - so no draw ever pays a
+// per-pixel branch on bUseTexture/bUseLighting or the per-draw uniform
+// traffic that drove those flags
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+class ShaderVariants
+{
+public:
+	// one program per combination of the two feature defines
+	static const int VARIANT_COUNT = 4;
+
+	// access to the single shared instance
+	static ShaderVariants& Instance();
+
+	// load the shared GLSL sources and compile every permutation -
+	// returns false when any of the programs fails to build
+	bool Create(const char* vertexPath, const char* fragmentPath);
+
+	// the bucketing key for the permutation a draw needs - the
+	// render queue sorts on this so draws sharing a program run
+	// back to back and the program switches between them vanish
+	static int VariantIndex(bool bTextured, bool bLit);
+
+	// activate the permutation for the passed in draw state and
+	// point the uniform cache at its program - a no-op when the
+	// permutation is already active
+	void Use(bool bTextured, bool bLit);
+
+private:
+	ShaderVariants() {}
+
+	// read a GLSL source file into the passed in string
+	static bool ReadSourceFile(const char* filePath, std::string& source);
+
+	// the file source with the permutation defines injected after
+	// its #version directive
+	static std::string InjectDefines(
+		const std::string& source,
+		bool bTextured,
+		bool bLit);
+
+	// the linked program of every permutation, indexed by
+	// VariantIndex()
+	GLuint m_programIDs[VARIANT_COUNT] = { 0, 0, 0, 0 };
+
+	// the permutation currently active, so consecutive draws with
+	// the same state never re-activate the program
+	int m_activeVariant = -1;
+};
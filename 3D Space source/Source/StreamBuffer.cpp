@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// streambuffer.cpp
+// ============
+// persistently mapped triple-buffered streaming storage - per-frame data
+// is written straight into GPU visible memory through a mapping that
+// stays alive for the whole session, with one third of the buffer per
+// in-flight frame and a fence guarding each third, so the CPU never
+// waits on a transfer and never overwrites data the GPU still reads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StreamBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// offset binds of uniform and storage buffers require this
+	// alignment on every implementation we target
+	const size_t g_OffsetAlignment = 256;
+}
+
+/***********************************************************
+ *  StreamBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StreamBuffer::StreamBuffer()
+{
+}
+
+/***********************************************************
+ *  ~StreamBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StreamBuffer::~StreamBuffer()
+{
+	for (int region = 0; region < REGION_COUNT; region++)
+	{
+		if (m_regionFences[region] != nullptr)
+		{
+			glDeleteSync(m_regionFences[region]);
+			m_regionFences[region] = nullptr;
+		}
+	}
+
+	if (m_bufferID != 0)
+	{
+		glBindBuffer(m_target, m_bufferID);
+		glUnmapBuffer(m_target);
+		glBindBuffer(m_target, 0);
+		glDeleteBuffers(1, &m_bufferID);
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method creates the immutable backing storage for
+ *  all of the frame regions and maps it once - the mapping
+ *  stays alive until the object is destroyed.
+ ***********************************************************/
+void StreamBuffer::Create(GLenum target, size_t regionSize)
+{
+	m_target = target;
+
+	// round the region up so every region starts on an offset
+	// the buffer range binds accept
+	m_regionSize = (regionSize + g_OffsetAlignment - 1) &
+		~(g_OffsetAlignment - 1);
+
+	const GLbitfield storageFlags =
+		GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(m_target, m_bufferID);
+	glBufferStorage(m_target, m_regionSize * REGION_COUNT, NULL, storageFlags);
+
+	m_mappedMemory = (unsigned char*)glMapBufferRange(
+		m_target, 0, m_regionSize * REGION_COUNT, storageFlags);
+	glBindBuffer(m_target, 0);
+
+	if (NULL == m_mappedMemory)
+	{
+		std::cout << "Could not persistently map the stream buffer" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method steps to the next frame region - if the GPU
+ *  has not finished the frame that used this region two
+ *  frames ago, the fence wait here is the only stall the
+ *  streaming path can take.
+ ***********************************************************/
+void StreamBuffer::BeginFrame()
+{
+	m_regionIndex = (m_regionIndex + 1) % REGION_COUNT;
+	m_regionWriteOffset = 0;
+
+	if (m_regionFences[m_regionIndex] != nullptr)
+	{
+		GLenum waitResult = GL_UNSIGNALED;
+		do
+		{
+			waitResult = glClientWaitSync(
+				m_regionFences[m_regionIndex],
+				GL_SYNC_FLUSH_COMMANDS_BIT,
+				1000000);
+		} while ((waitResult != GL_ALREADY_SIGNALED) &&
+			(waitResult != GL_CONDITION_SATISFIED));
+
+		glDeleteSync(m_regionFences[m_regionIndex]);
+		m_regionFences[m_regionIndex] = nullptr;
+	}
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method copies data into the current frame region
+ *  through the persistent mapping and returns where inside
+ *  the buffer it landed.
+ ***********************************************************/
+bool StreamBuffer::Write(const void* sourceData, size_t byteCount, size_t& byteOffset)
+{
+	if ((NULL == m_mappedMemory) ||
+		((m_regionWriteOffset + byteCount) > m_regionSize))
+	{
+		return(false);
+	}
+
+	byteOffset = (size_t)m_regionIndex * m_regionSize + m_regionWriteOffset;
+	memcpy(m_mappedMemory + byteOffset, sourceData, byteCount);
+
+	// keep later writes of the same frame on a bindable offset
+	m_regionWriteOffset += (byteCount + g_OffsetAlignment - 1) &
+		~(g_OffsetAlignment - 1);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method drops a fence behind the GPU commands that
+ *  read the current frame region, so BeginFrame() knows
+ *  when the region can be reused.
+ ***********************************************************/
+void StreamBuffer::EndFrame()
+{
+	if (m_regionFences[m_regionIndex] != nullptr)
+	{
+		glDeleteSync(m_regionFences[m_regionIndex]);
+	}
+	m_regionFences[m_regionIndex] =
+		glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
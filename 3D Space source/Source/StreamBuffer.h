@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// streambuffer.h
+// ============
+// persistently mapped triple-buffered streaming storage - per-frame data
+// is written straight into GPU visible memory through a mapping that
+// stays alive for the whole session, with one third of the buffer per
+// in-flight frame and a fence guarding each third, so the CPU never
+// waits on a transfer and never overwrites data the GPU still reads
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+class StreamBuffer
+{
+public:
+	// constructor
+	StreamBuffer();
+	// destructor
+	~StreamBuffer();
+
+	// create the immutable backing storage and map it once -
+	// regionSize bytes are available per in-flight frame and
+	// are rounded up to the offset alignment binds require
+	void Create(GLenum target, size_t regionSize);
+
+	// step to the next frame region, waiting on the fence of
+	// the frame that used it two frames ago if the GPU has
+	// not finished it yet
+	void BeginFrame();
+
+	// copy data into the current frame region and return its
+	// byte offset inside the buffer, for offset binds and
+	// indirect draws - returns false when the region is full
+	bool Write(const void* sourceData, size_t byteCount, size_t& byteOffset);
+
+	// fence the current frame region - called after the GPU
+	// commands reading from it have been issued
+	void EndFrame();
+
+	// the GL buffer object holding all three regions
+	GLuint GetBufferID() const { return(m_bufferID); }
+
+private:
+	// number of frame regions that can be in flight at once
+	static const int REGION_COUNT = 3;
+
+	GLuint m_bufferID = 0;
+	GLenum m_target = 0;
+
+	// the persistent mapping over the whole buffer
+	unsigned char* m_mappedMemory = nullptr;
+
+	// frame region bookkeeping
+	size_t m_regionSize = 0;
+	int m_regionIndex = 0;
+	size_t m_regionWriteOffset = 0;
+
+	// one fence per region, signaled when the GPU finished
+	// the frame that wrote it
+	GLsync m_regionFences[REGION_COUNT] = { nullptr, nullptr, nullptr };
+};
@@ -0,0 +1,379 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearray.cpp
+// ============
+// packs the scene textures into one GL_TEXTURE_2D_ARRAY bound once at
+// startup - objects carry a layer index instead of a texture unit, so
+// the draw loops never rebind a sampler and the old 16 texture unit
+// ceiling no longer applies
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureArray.h"
+
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// the VRAM the array allocation may occupy, in megabytes -
+	// zero leaves the layer size uncapped
+	int g_VRAMBudgetMegabytes = 0;
+
+	// the smallest layer size the budget may force - below this
+	// the textures stop reading as surfaces at all
+	const int g_MinimumLayerSize = 128;
+
+	// bytes of one RGBA8 layer including its mip chain - the
+	// chain converges to 4/3 of the top level
+	size_t LayerByteSize(int layerSize)
+	{
+		return(((size_t)layerSize * (size_t)layerSize * 4 * 4) / 3);
+	}
+
+	/*******************************************************
+	 *  ResampleToLayer()
+	 *
+	 *  This function converts an image to RGBA and bilinearly
+	 *  resamples it to the passed in layer size, so any
+	 *  decoded image fits the array's single allocation.
+	 *******************************************************/
+	void ResampleToLayer(
+		const unsigned char* pixels,
+		int width,
+		int height,
+		int colorChannels,
+		int layerSize,
+		std::vector<unsigned char>& layerPixels)
+	{
+		layerPixels.resize((size_t)layerSize * (size_t)layerSize * 4);
+
+		for (int destY = 0; destY < layerSize; destY++)
+		{
+			// map the destination pixel center back into the
+			// source image
+			float sourceY = ((float)destY + 0.5f) /
+				(float)layerSize * (float)height - 0.5f;
+			int y0 = (int)sourceY;
+			if (y0 < 0) y0 = 0;
+			int y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+			float fractionY = sourceY - (float)y0;
+			if (fractionY < 0.0f) fractionY = 0.0f;
+
+			for (int destX = 0; destX < layerSize; destX++)
+			{
+				float sourceX = ((float)destX + 0.5f) /
+					(float)layerSize * (float)width - 0.5f;
+				int x0 = (int)sourceX;
+				if (x0 < 0) x0 = 0;
+				int x1 = (x0 + 1 < width) ? x0 + 1 : x0;
+				float fractionX = sourceX - (float)x0;
+				if (fractionX < 0.0f) fractionX = 0.0f;
+
+				unsigned char* destination = &layerPixels[
+					((size_t)destY * layerSize + destX) * 4];
+
+				for (int channel = 0; channel < 4; channel++)
+				{
+					// images without an alpha channel fill in opaque
+					if (channel >= colorChannels)
+					{
+						destination[channel] = (channel == 3) ? 255 : 0;
+						continue;
+					}
+
+					float topLeft = (float)pixels[(y0 * width + x0) * colorChannels + channel];
+					float topRight = (float)pixels[(y0 * width + x1) * colorChannels + channel];
+					float bottomLeft = (float)pixels[(y1 * width + x0) * colorChannels + channel];
+					float bottomRight = (float)pixels[(y1 * width + x1) * colorChannels + channel];
+
+					float top = topLeft + (topRight - topLeft) * fractionX;
+					float bottom = bottomLeft + (bottomRight - bottomLeft) * fractionX;
+					float value = top + (bottom - top) * fractionY;
+
+					destination[channel] = (unsigned char)(value + 0.5f);
+				}
+			}
+		}
+	}
+
+	/*******************************************************
+	 *  DownsampleMip()
+	 *
+	 *  This function box-filters an RGBA mip level down to
+	 *  the next level - each destination pixel averages the
+	 *  2 x 2 source block above it.
+	 *******************************************************/
+	void DownsampleMip(
+		const std::vector<unsigned char>& sourcePixels,
+		int sourceSize,
+		std::vector<unsigned char>& destPixels)
+	{
+		int destSize = (sourceSize > 1) ? (sourceSize / 2) : 1;
+		destPixels.resize((size_t)destSize * (size_t)destSize * 4);
+
+		for (int destY = 0; destY < destSize; destY++)
+		{
+			int y0 = destY * 2;
+			int y1 = (y0 + 1 < sourceSize) ? y0 + 1 : y0;
+
+			for (int destX = 0; destX < destSize; destX++)
+			{
+				int x0 = destX * 2;
+				int x1 = (x0 + 1 < sourceSize) ? x0 + 1 : x0;
+
+				unsigned char* destination = &destPixels[
+					((size_t)destY * destSize + destX) * 4];
+
+				for (int channel = 0; channel < 4; channel++)
+				{
+					int sum =
+						(int)sourcePixels[((size_t)y0 * sourceSize + x0) * 4 + channel] +
+						(int)sourcePixels[((size_t)y0 * sourceSize + x1) * 4 + channel] +
+						(int)sourcePixels[((size_t)y1 * sourceSize + x0) * 4 + channel] +
+						(int)sourcePixels[((size_t)y1 * sourceSize + x1) * 4 + channel];
+					destination[channel] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  TextureArray()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureArray::TextureArray()
+{
+}
+
+/***********************************************************
+ *  ~TextureArray()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureArray::~TextureArray()
+{
+	if (m_textureID != 0)
+	{
+		glDeleteTextures(1, &m_textureID);
+	}
+}
+
+/***********************************************************
+ *  SetVRAMBudget()
+ *
+ *  This method caps the VRAM the texture array may occupy -
+ *  the budget must be set before Create() sizes the
+ *  allocation.
+ ***********************************************************/
+void TextureArray::SetVRAMBudget(int budgetMegabytes)
+{
+	g_VRAMBudgetMegabytes = budgetMegabytes;
+	std::cout << "INFO: Texture VRAM budget set to "
+		<< budgetMegabytes << "MB" << std::endl;
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method allocates the array texture storage - one
+ *  immutable allocation holding every layer and its mips,
+ *  with the layer size halved until the whole allocation
+ *  fits the VRAM budget.
+ ***********************************************************/
+void TextureArray::Create()
+{
+	if (m_textureID != 0)
+	{
+		return;
+	}
+
+	// pick the largest layer size whose full allocation fits
+	// the budget - everything the array will ever need is
+	// resident from the start, so the frame loop never waits
+	// on driver paging
+	m_layerSize = LAYER_SIZE;
+	if (g_VRAMBudgetMegabytes > 0)
+	{
+		size_t budgetBytes = (size_t)g_VRAMBudgetMegabytes * 1024 * 1024;
+		while ((m_layerSize > g_MinimumLayerSize) &&
+			(LayerByteSize(m_layerSize) * MAX_LAYERS > budgetBytes))
+		{
+			m_layerSize /= 2;
+		}
+	}
+
+	// mip chain length for the chosen size, down to 1 x 1
+	m_mipLevelCount = 1;
+	for (int size = m_layerSize; size > 1; size /= 2)
+	{
+		m_mipLevelCount++;
+	}
+
+	std::cout << "INFO: Texture array layers are " << m_layerSize
+		<< "x" << m_layerSize << " ("
+		<< ((LayerByteSize(m_layerSize) * MAX_LAYERS) / (1024 * 1024))
+		<< "MB resident)" << std::endl;
+
+	glGenTextures(1, &m_textureID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_mipLevelCount, GL_RGBA8,
+		m_layerSize, m_layerSize, MAX_LAYERS);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  AllocateLayer()
+ *
+ *  This method reserves the next layer and fills it with a
+ *  neutral gray so the scene renders reasonably until the
+ *  real pixels arrive.
+ ***********************************************************/
+int TextureArray::AllocateLayer()
+{
+	if (m_layerCount >= MAX_LAYERS)
+	{
+		std::cout << "WARNING: Texture array is full (" << MAX_LAYERS
+			<< " layers)" << std::endl;
+		return(-1);
+	}
+
+	int layer = m_layerCount;
+	m_layerCount++;
+
+	const unsigned char placeholderPixel[4] = { 128, 128, 128, 255 };
+	UploadLayer(layer, placeholderPixel, 1, 1, 4);
+
+	return(layer);
+}
+
+/***********************************************************
+ *  UploadLayer()
+ *
+ *  This method uploads image pixels into a reserved layer -
+ *  the mip pyramid is built on the CPU and uploaded level by
+ *  level, so no call ever regenerates mips across the whole
+ *  array.
+ ***********************************************************/
+void TextureArray::UploadLayer(
+	int layer,
+	const unsigned char* pixels,
+	int width,
+	int height,
+	int colorChannels)
+{
+	std::vector<std::vector<unsigned char>> mipPixels;
+	BuildLayerMips(pixels, width, height, colorChannels, mipPixels);
+	UploadLayerMips(layer, mipPixels);
+}
+
+/***********************************************************
+ *  BuildLayerMips()
+ *
+ *  This method resamples an image to the layer size and
+ *  box-filters its full mip pyramid - pure CPU work, safe to
+ *  run on the decode workers so the GL thread only pays for
+ *  the transfers.
+ ***********************************************************/
+void TextureArray::BuildLayerMips(
+	const unsigned char* pixels,
+	int width,
+	int height,
+	int colorChannels,
+	std::vector<std::vector<unsigned char>>& mipPixels) const
+{
+	mipPixels.clear();
+
+	if ((colorChannels != 1) && (colorChannels != 3) && (colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with "
+			<< colorChannels << " channels" << std::endl;
+		return;
+	}
+
+	mipPixels.resize(m_mipLevelCount);
+	ResampleToLayer(pixels, width, height, colorChannels,
+		m_layerSize, mipPixels[0]);
+
+	int mipSize = m_layerSize;
+	for (int mipLevel = 1; mipLevel < m_mipLevelCount; mipLevel++)
+	{
+		DownsampleMip(mipPixels[mipLevel - 1], mipSize, mipPixels[mipLevel]);
+		mipSize = (mipSize > 1) ? (mipSize / 2) : 1;
+	}
+}
+
+/***********************************************************
+ *  UploadLayerMips()
+ *
+ *  This method uploads a prebuilt mip pyramid into a
+ *  reserved layer, one glTexSubImage3D per level.
+ ***********************************************************/
+void TextureArray::UploadLayerMips(
+	int layer,
+	const std::vector<std::vector<unsigned char>>& mipPixels)
+{
+	if ((layer < 0) || (layer >= m_layerCount) ||
+		((int)mipPixels.size() != m_mipLevelCount))
+	{
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+
+	int mipSize = m_layerSize;
+	for (int mipLevel = 0; mipLevel < m_mipLevelCount; mipLevel++)
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mipLevel,
+			0, 0, layer, mipSize, mipSize, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, mipPixels[mipLevel].data());
+		mipSize = (mipSize > 1) ? (mipSize / 2) : 1;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method binds the array to the passed in texture
+ *  unit - done once, every draw then selects its texture
+ *  by layer index.
+ ***********************************************************/
+void TextureArray::Bind(int textureUnit)
+{
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+}
+
+/***********************************************************
+ *  GetLayerCount()
+ *
+ *  This method returns the number of layers reserved so
+ *  far.
+ ***********************************************************/
+int TextureArray::GetLayerCount() const
+{
+	return(m_layerCount);
+}
+
+/***********************************************************
+ *  GetLayerSize()
+ *
+ *  This method returns the layer size Create() settled on
+ *  under the VRAM budget.
+ ***********************************************************/
+int TextureArray::GetLayerSize() const
+{
+	return(m_layerSize);
+}
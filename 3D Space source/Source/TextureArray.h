@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearray.h
+// ============
+// packs the scene textures into one GL_TEXTURE_2D_ARRAY bound once at
+// startup - objects carry a layer index instead of a texture unit, so
+// the draw loops never rebind a sampler and the old 16 texture unit
+// ceiling no longer applies
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+class TextureArray
+{
+public:
+	// the largest layer size - images are resampled into the
+	// layer size on upload so the array stays a single
+	// allocation; a VRAM budget can cap the actual size below
+	// this
+	static const int LAYER_SIZE = 1024;
+
+	// number of layers the array is allocated with - well above
+	// the old 16 texture unit ceiling, and raising it is just a
+	// bigger allocation rather than an API limit
+	static const int MAX_LAYERS = 64;
+
+	// constructor
+	TextureArray();
+	// destructor
+	~TextureArray();
+
+	// cap the VRAM the array may occupy - Create() halves the
+	// layer size until the whole allocation, mips included,
+	// fits the budget; the array is one immutable allocation
+	// that is always resident, so the budget is honored up
+	// front instead of through driver paging mid-frame
+	static void SetVRAMBudget(int budgetMegabytes);
+
+	// allocate the array texture storage - must be called once
+	// before any layers are added
+	void Create();
+
+	// reserve the next layer, filled with a neutral gray until
+	// real pixels arrive - returns -1 when the array is full
+	int AllocateLayer();
+
+	// upload image pixels into a reserved layer - the image is
+	// converted to RGBA and resampled to the layer size, and
+	// the mip chain is refreshed
+	void UploadLayer(
+		int layer,
+		const unsigned char* pixels,
+		int width,
+		int height,
+		int colorChannels);
+
+	// resample an image to the layer size and box-filter its
+	// full mip pyramid - pure CPU work reading no GL state, so
+	// the decode workers run it in the background
+	void BuildLayerMips(
+		const unsigned char* pixels,
+		int width,
+		int height,
+		int colorChannels,
+		std::vector<std::vector<unsigned char>>& mipPixels) const;
+
+	// upload a prebuilt mip pyramid into a reserved layer -
+	// the per-level transfers are all the GL thread pays, no
+	// mip generation over the whole array
+	void UploadLayerMips(
+		int layer,
+		const std::vector<std::vector<unsigned char>>& mipPixels);
+
+	// bind the array to the passed in texture unit - done once,
+	// every draw then selects its texture by layer index
+	void Bind(int textureUnit);
+
+	// number of layers reserved so far
+	int GetLayerCount() const;
+
+	// the layer size Create() settled on under the VRAM budget
+	int GetLayerSize() const;
+
+private:
+	// the array texture object
+	GLuint m_textureID = 0;
+	// number of layers reserved so far
+	int m_layerCount = 0;
+	// layer size and mip chain length picked by Create()
+	int m_layerSize = LAYER_SIZE;
+	int m_mipLevelCount = 0;
+};
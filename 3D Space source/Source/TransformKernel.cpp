@@ -0,0 +1,283 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformkernel.cpp
+// ============
+// composes model matrices for batches of scene transforms - the transform
+// components are staged in structure-of-arrays form and the matrices are
+// built four at a time with SSE, replacing the chain of per-object mat4
+// multiplies that dominated the CPU time in animated scenes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformKernel.h"
+
+#include <cmath>
+
+// the SSE path covers every x64 build and x86 builds compiled
+// with at least /arch:SSE2
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TRANSFORM_KERNEL_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables and defines
+namespace
+{
+	const float g_DegreesToRadians = 0.01745329251994329577f;
+
+#if defined(TRANSFORM_KERNEL_SSE)
+	/*******************************************************
+	 *  SinCos4()
+	 *
+	 *  This function computes the sine and cosine of four
+	 *  angles at once - the classic Cephes range reduction
+	 *  and minimax polynomials, accurate to a few ULP over
+	 *  the rotation ranges the scene uses.
+	 *******************************************************/
+	void SinCos4(__m128 x, __m128& sines, __m128& cosines)
+	{
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+
+		__m128 sinSign = _mm_and_ps(x, signMask);
+		x = _mm_andnot_ps(signMask, x);
+
+		// quadrant index j = round-to-even of |x| * 4/pi
+		__m128 y = _mm_mul_ps(x, _mm_set1_ps(1.27323954473516f));
+		__m128i j = _mm_cvttps_epi32(y);
+		j = _mm_add_epi32(j, _mm_set1_epi32(1));
+		j = _mm_and_si128(j, _mm_set1_epi32(~1));
+		y = _mm_cvtepi32_ps(j);
+
+		__m128i jForCos = j;
+
+		// the sign of the sine flips in quadrants 4..7
+		__m128i signBits = _mm_and_si128(j, _mm_set1_epi32(4));
+		signBits = _mm_slli_epi32(signBits, 29);
+		__m128 swapSignSin = _mm_castsi128_ps(signBits);
+
+		// polynomial selection - quadrants where |x| reduces
+		// into the sine polynomial instead of the cosine one
+		__m128i polyBits = _mm_and_si128(j, _mm_set1_epi32(2));
+		polyBits = _mm_cmpeq_epi32(polyBits, _mm_setzero_si128());
+		__m128 polyMask = _mm_castsi128_ps(polyBits);
+
+		// extended-precision modular reduction of x by j*pi/4
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+
+		// the sign of the cosine flips in quadrants 2..5
+		jForCos = _mm_sub_epi32(jForCos, _mm_set1_epi32(2));
+		jForCos = _mm_andnot_si128(jForCos, _mm_set1_epi32(4));
+		jForCos = _mm_slli_epi32(jForCos, 29);
+		__m128 cosSign = _mm_castsi128_ps(jForCos);
+
+		sinSign = _mm_xor_ps(sinSign, swapSignSin);
+
+		__m128 z = _mm_mul_ps(x, x);
+
+		// cosine polynomial over the reduced range
+		__m128 cosPoly = _mm_set1_ps(2.443315711809948e-5f);
+		cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(-1.388731625493765e-3f));
+		cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(4.166664568298827e-2f));
+		cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+		cosPoly = _mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+		cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+		// sine polynomial over the reduced range
+		__m128 sinPoly = _mm_set1_ps(-1.9515295891e-4f);
+		sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(8.3321608736e-3f));
+		sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(-1.6666654611e-1f));
+		sinPoly = _mm_mul_ps(_mm_mul_ps(sinPoly, z), x);
+		sinPoly = _mm_add_ps(sinPoly, x);
+
+		// select the polynomial for each lane's quadrant
+		__m128 sinFromSin = _mm_and_ps(polyMask, sinPoly);
+		__m128 sinFromCos = _mm_andnot_ps(polyMask, cosPoly);
+		__m128 cosFromCos = _mm_and_ps(polyMask, cosPoly);
+		__m128 cosFromSin = _mm_andnot_ps(polyMask, sinPoly);
+
+		sines = _mm_xor_ps(_mm_or_ps(sinFromSin, sinFromCos), sinSign);
+		cosines = _mm_xor_ps(_mm_or_ps(cosFromCos, cosFromSin), cosSign);
+	}
+
+	/*******************************************************
+	 *  LoadLanes4()
+	 *
+	 *  This function loads up to four lanes from a component
+	 *  array, zero padding past the end of the batch.
+	 *******************************************************/
+	__m128 LoadLanes4(const float* values, int laneCount)
+	{
+		if (laneCount >= 4)
+		{
+			return(_mm_loadu_ps(values));
+		}
+
+		float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			lanes[lane] = values[lane];
+		}
+		return(_mm_loadu_ps(lanes));
+	}
+#else
+	/*******************************************************
+	 *  ComposeScalar()
+	 *
+	 *  This function composes one model matrix with scalar
+	 *  math - the same analytic expansion the SSE batches
+	 *  use, for targets without SSE2.
+	 *******************************************************/
+	void ComposeScalar(
+		const TransformKernel::TRANSFORM_SOA& transforms,
+		int index,
+		glm::mat4* modelMatrices)
+	{
+		float sinX = std::sin(transforms.rotationDegreesX[index] * g_DegreesToRadians);
+		float cosX = std::cos(transforms.rotationDegreesX[index] * g_DegreesToRadians);
+		float sinY = std::sin(transforms.rotationDegreesY[index] * g_DegreesToRadians);
+		float cosY = std::cos(transforms.rotationDegreesY[index] * g_DegreesToRadians);
+		float sinZ = std::sin(transforms.rotationDegreesZ[index] * g_DegreesToRadians);
+		float cosZ = std::cos(transforms.rotationDegreesZ[index] * g_DegreesToRadians);
+
+		float scaleX = transforms.scaleX[index];
+		float scaleY = transforms.scaleY[index];
+		float scaleZ = transforms.scaleZ[index];
+
+		modelMatrices[index] = glm::mat4(
+			cosY * cosZ * scaleX,
+			(cosX * sinZ + sinX * sinY * cosZ) * scaleX,
+			(sinX * sinZ - cosX * sinY * cosZ) * scaleX,
+			0.0f,
+			-cosY * sinZ * scaleY,
+			(cosX * cosZ - sinX * sinY * sinZ) * scaleY,
+			(sinX * cosZ + cosX * sinY * sinZ) * scaleY,
+			0.0f,
+			sinY * scaleZ,
+			-sinX * cosY * scaleZ,
+			cosX * cosY * scaleZ,
+			0.0f,
+			transforms.positionX[index],
+			transforms.positionY[index],
+			transforms.positionZ[index],
+			1.0f);
+	}
+#endif
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method sizes every component array for the batch.
+ ***********************************************************/
+void TransformKernel::TRANSFORM_SOA::Resize(int transformCount)
+{
+	scaleX.resize(transformCount);
+	scaleY.resize(transformCount);
+	scaleZ.resize(transformCount);
+	rotationDegreesX.resize(transformCount);
+	rotationDegreesY.resize(transformCount);
+	rotationDegreesZ.resize(transformCount);
+	positionX.resize(transformCount);
+	positionY.resize(transformCount);
+	positionZ.resize(transformCount);
+}
+
+/***********************************************************
+ *  ComposeModelMatrices()
+ *
+ *  This method composes the model matrices for a slice of
+ *  the staged batch - the rotation terms of the expanded
+ *  translate * rotX * rotY * rotZ * scale product are
+ *  evaluated four transforms at a time with SSE, and only
+ *  the finished columns are scattered back out.
+ ***********************************************************/
+void TransformKernel::ComposeModelMatrices(
+	const TRANSFORM_SOA& transforms,
+	int rangeBegin,
+	int rangeEnd,
+	glm::mat4* modelMatrices)
+{
+#if defined(TRANSFORM_KERNEL_SSE)
+	const __m128 degreesToRadians = _mm_set1_ps(g_DegreesToRadians);
+
+	for (int batchStart = rangeBegin; batchStart < rangeEnd; batchStart += 4)
+	{
+		int laneCount = rangeEnd - batchStart;
+		if (laneCount > 4)
+		{
+			laneCount = 4;
+		}
+
+		// the sines and cosines of all three rotation angles,
+		// four transforms per call
+		__m128 sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCos4(_mm_mul_ps(LoadLanes4(
+			&transforms.rotationDegreesX[batchStart], laneCount),
+			degreesToRadians), sinX, cosX);
+		SinCos4(_mm_mul_ps(LoadLanes4(
+			&transforms.rotationDegreesY[batchStart], laneCount),
+			degreesToRadians), sinY, cosY);
+		SinCos4(_mm_mul_ps(LoadLanes4(
+			&transforms.rotationDegreesZ[batchStart], laneCount),
+			degreesToRadians), sinZ, cosZ);
+
+		__m128 scaleX = LoadLanes4(&transforms.scaleX[batchStart], laneCount);
+		__m128 scaleY = LoadLanes4(&transforms.scaleY[batchStart], laneCount);
+		__m128 scaleZ = LoadLanes4(&transforms.scaleZ[batchStart], laneCount);
+
+		// the nine rotation terms, scaled per column - this is
+		// the expanded rotX * rotY * rotZ product
+		__m128 sinXsinY = _mm_mul_ps(sinX, sinY);
+		__m128 cosXsinY = _mm_mul_ps(cosX, sinY);
+
+		__m128 m00 = _mm_mul_ps(_mm_mul_ps(cosY, cosZ), scaleX);
+		__m128 m10 = _mm_mul_ps(_mm_add_ps(
+			_mm_mul_ps(cosX, sinZ), _mm_mul_ps(sinXsinY, cosZ)), scaleX);
+		__m128 m20 = _mm_mul_ps(_mm_sub_ps(
+			_mm_mul_ps(sinX, sinZ), _mm_mul_ps(cosXsinY, cosZ)), scaleX);
+
+		__m128 m01 = _mm_mul_ps(_mm_sub_ps(
+			_mm_setzero_ps(), _mm_mul_ps(cosY, sinZ)), scaleY);
+		__m128 m11 = _mm_mul_ps(_mm_sub_ps(
+			_mm_mul_ps(cosX, cosZ), _mm_mul_ps(sinXsinY, sinZ)), scaleY);
+		__m128 m21 = _mm_mul_ps(_mm_add_ps(
+			_mm_mul_ps(sinX, cosZ), _mm_mul_ps(cosXsinY, sinZ)), scaleY);
+
+		__m128 m02 = _mm_mul_ps(sinY, scaleZ);
+		__m128 m12 = _mm_mul_ps(_mm_sub_ps(
+			_mm_setzero_ps(), _mm_mul_ps(sinX, cosY)), scaleZ);
+		__m128 m22 = _mm_mul_ps(_mm_mul_ps(cosX, cosY), scaleZ);
+
+		// scatter the finished columns into the output matrices
+		float lane00[4], lane10[4], lane20[4];
+		float lane01[4], lane11[4], lane21[4];
+		float lane02[4], lane12[4], lane22[4];
+		_mm_storeu_ps(lane00, m00);
+		_mm_storeu_ps(lane10, m10);
+		_mm_storeu_ps(lane20, m20);
+		_mm_storeu_ps(lane01, m01);
+		_mm_storeu_ps(lane11, m11);
+		_mm_storeu_ps(lane21, m21);
+		_mm_storeu_ps(lane02, m02);
+		_mm_storeu_ps(lane12, m12);
+		_mm_storeu_ps(lane22, m22);
+
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			modelMatrices[batchStart + lane] = glm::mat4(
+				lane00[lane], lane10[lane], lane20[lane], 0.0f,
+				lane01[lane], lane11[lane], lane21[lane], 0.0f,
+				lane02[lane], lane12[lane], lane22[lane], 0.0f,
+				transforms.positionX[batchStart + lane],
+				transforms.positionY[batchStart + lane],
+				transforms.positionZ[batchStart + lane],
+				1.0f);
+		}
+	}
+#else
+	for (int index = rangeBegin; index < rangeEnd; index++)
+	{
+		ComposeScalar(transforms, index, modelMatrices);
+	}
+#endif
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.cpp
+// ============
+// manages the uniform buffer objects holding the per-frame camera state
+// and the scene lighting rig - every shader program reads them from the
+// same binding points, and a block is only re-uploaded when its contents
+// actually changed
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformBlocks.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// the binding points the shader sources declare
+	const GLuint g_CameraBindingPoint = 0;
+	const GLuint g_LightingBindingPoint = 1;
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared uniform block
+ *  manager used by all of the rendering code.
+ ***********************************************************/
+UniformBlocks& UniformBlocks::Instance()
+{
+	static UniformBlocks instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method creates the camera and lighting buffers and
+ *  attaches them to the binding points the shader sources
+ *  declare - the attachments are context global, so every
+ *  program sees the same blocks.
+ ***********************************************************/
+void UniformBlocks::Create()
+{
+	glGenBuffers(1, &m_cameraBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_cameraBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CAMERA_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_CameraBindingPoint, m_cameraBuffer);
+
+	glGenBuffers(1, &m_lightingBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightingBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LIGHTING_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_LightingBindingPoint, m_lightingBuffer);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetCameraBlock()
+ *
+ *  This method uploads the per-frame camera state with one
+ *  glBufferSubData call, skipped entirely when the camera
+ *  has not moved since the last upload.
+ ***********************************************************/
+void UniformBlocks::SetCameraBlock(const CAMERA_BLOCK& cameraBlock)
+{
+	if ((m_bCameraUploaded == true) &&
+		(memcmp(&cameraBlock, &m_lastCamera, sizeof(CAMERA_BLOCK)) == 0))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_cameraBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CAMERA_BLOCK), &cameraBlock);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	m_lastCamera = cameraBlock;
+	m_bCameraUploaded = true;
+}
+
+/***********************************************************
+ *  SetLightingBlock()
+ *
+ *  This method uploads the scene lighting rig with one
+ *  glBufferSubData call, skipped entirely when the lights
+ *  have not changed since the last upload.
+ ***********************************************************/
+void UniformBlocks::SetLightingBlock(const LIGHTING_BLOCK& lightingBlock)
+{
+	if ((m_bLightingUploaded == true) &&
+		(memcmp(&lightingBlock, &m_lastLighting, sizeof(LIGHTING_BLOCK)) == 0))
+	{
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightingBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LIGHTING_BLOCK), &lightingBlock);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	m_lastLighting = lightingBlock;
+	m_bLightingUploaded = true;
+}
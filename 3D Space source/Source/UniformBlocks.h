@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.h
+// ============
+// manages the uniform buffer objects holding the per-frame camera state
+// and the scene lighting rig - every shader program reads them from the
+// same binding points, and a block is only re-uploaded when its contents
+// actually changed
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+class UniformBlocks
+{
+public:
+	// std140 layout of the camera block at binding point 0
+	struct CAMERA_BLOCK
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec4 viewPosition;
+	};
+
+	// std140 layout of the lighting block at binding point 1
+	struct LIGHTING_BLOCK
+	{
+		glm::vec4 dirLightDirection;
+		glm::vec4 dirLightAmbient;
+		glm::vec4 dirLightDiffuse;
+		glm::vec4 spotLightPosition;
+		glm::vec4 spotLightDirection;
+		glm::vec4 spotLightAmbient;
+		glm::vec4 spotLightDiffuse;
+		glm::vec4 spotLightSpecular;
+		// constant, linear, quadratic attenuation
+		glm::vec4 spotLightAttenuation;
+		// cutOff and outerCutOff cosines
+		glm::vec4 spotLightCone;
+	};
+
+	// access to the single shared instance
+	static UniformBlocks& Instance();
+
+	// create the buffers and attach them to their binding
+	// points - must be called once with an active GL context
+	void Create();
+
+	// upload a block, skipping the transfer when the contents
+	// match what the GPU already holds
+	void SetCameraBlock(const CAMERA_BLOCK& cameraBlock);
+	void SetLightingBlock(const LIGHTING_BLOCK& lightingBlock);
+
+private:
+	UniformBlocks() {}
+
+	GLuint m_cameraBuffer = 0;
+	GLuint m_lightingBuffer = 0;
+
+	// last uploaded contents, used for the dirty check
+	CAMERA_BLOCK m_lastCamera;
+	LIGHTING_BLOCK m_lastLighting;
+	bool m_bCameraUploaded = false;
+	bool m_bLightingUploaded = false;
+};
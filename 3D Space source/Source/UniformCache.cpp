@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcache.cpp
+// ============
+// caches the uniform locations and last-sent values per shader program so
+// the render loop does not resolve uniforms by string name or re-send
+// values a program already holds - with the specialized shader
+// permutations the active program changes mid-frame, so every program
+// keeps its own cache bucket
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "FrameProfiler.h"
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method returns the single shared uniform cache
+ *  that is used by all of the scene rendering code.
+ ***********************************************************/
+UniformCache& UniformCache::Instance()
+{
+	static UniformCache instance;
+	return(instance);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method drops every cached location and value and
+ *  resolves against the currently active shader program -
+ *  only needed when programs are relinked.
+ ***********************************************************/
+void UniformCache::Reset()
+{
+	GLint currentProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+
+	m_programCaches.clear();
+	m_activeCache = nullptr;
+	m_programID = 0;
+
+	SetActiveProgram((GLuint)currentProgram);
+}
+
+/***********************************************************
+ *  SetActiveProgram()
+ *
+ *  This method points the cache at the passed in shader
+ *  program, creating its bucket the first time the program
+ *  is seen - the buckets persist, so a program keeps its
+ *  dirty-check state across switches.
+ ***********************************************************/
+void UniformCache::SetActiveProgram(GLuint programID)
+{
+	if ((programID == m_programID) && (m_activeCache != nullptr))
+	{
+		return;
+	}
+
+	m_programID = programID;
+	m_activeCache = &m_programCaches[programID];
+}
+
+/***********************************************************
+ *  GetUniformLocation()
+ *
+ *  This method returns the location for the passed in
+ *  uniform name, only querying the OpenGL driver the first
+ *  time each name is requested for the active program.
+ ***********************************************************/
+GLint UniformCache::GetUniformLocation(const std::string& uniformName)
+{
+	// late first use - resolve against whatever program is
+	// active right now
+	if (m_activeCache == nullptr)
+	{
+		Reset();
+	}
+
+	auto cached = m_activeCache->uniformLocations.find(uniformName);
+	if (cached != m_activeCache->uniformLocations.end())
+	{
+		return(cached->second);
+	}
+
+	GLint location = glGetUniformLocation(m_programID, uniformName.c_str());
+	m_activeCache->uniformLocations[uniformName] = location;
+
+	return(location);
+}
+
+/***********************************************************
+ *  setIntValue()
+ *
+ *  This method sends the passed in integer value into the
+ *  shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setIntValue(const std::string& uniformName, int value)
+{
+	GLint location = GetUniformLocation(uniformName);
+	if (location < 0)
+	{
+		return;
+	}
+
+	auto last = m_activeCache->lastIntValues.find(location);
+	if ((last != m_activeCache->lastIntValues.end()) && (last->second == value))
+	{
+		return;
+	}
+
+	glUniform1i(location, value);
+	FrameProfiler::Instance().CountStateChange();
+	m_activeCache->lastIntValues[location] = value;
+}
+
+/***********************************************************
+ *  setFloatValue()
+ *
+ *  This method sends the passed in float value into the
+ *  shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setFloatValue(const std::string& uniformName, float value)
+{
+	GLint location = GetUniformLocation(uniformName);
+	if (location < 0)
+	{
+		return;
+	}
+
+	auto last = m_activeCache->lastFloatValues.find(location);
+	if ((last != m_activeCache->lastFloatValues.end()) && (last->second == value))
+	{
+		return;
+	}
+
+	glUniform1f(location, value);
+	FrameProfiler::Instance().CountStateChange();
+	m_activeCache->lastFloatValues[location] = value;
+}
+
+/***********************************************************
+ *  setVec2Value()
+ *
+ *  This method sends the passed in 2D vector value into the
+ *  shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setVec2Value(const std::string& uniformName, const glm::vec2& value)
+{
+	GLint location = GetUniformLocation(uniformName);
+	if (location < 0)
+	{
+		return;
+	}
+
+	auto last = m_activeCache->lastVec2Values.find(location);
+	if ((last != m_activeCache->lastVec2Values.end()) && (last->second == value))
+	{
+		return;
+	}
+
+	glUniform2fv(location, 1, glm::value_ptr(value));
+	FrameProfiler::Instance().CountStateChange();
+	m_activeCache->lastVec2Values[location] = value;
+}
+
+/***********************************************************
+ *  setVec3Value()
+ *
+ *  This method sends the passed in 3D vector value into the
+ *  shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setVec3Value(const std::string& uniformName, const glm::vec3& value)
+{
+	GLint location = GetUniformLocation(uniformName);
+	if (location < 0)
+	{
+		return;
+	}
+
+	auto last = m_activeCache->lastVec3Values.find(location);
+	if ((last != m_activeCache->lastVec3Values.end()) && (last->second == value))
+	{
+		return;
+	}
+
+	glUniform3fv(location, 1, glm::value_ptr(value));
+	FrameProfiler::Instance().CountStateChange();
+	m_activeCache->lastVec3Values[location] = value;
+}
+
+/***********************************************************
+ *  setVec4Value()
+ *
+ *  This method sends the passed in 4D vector value into the
+ *  shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setVec4Value(const std::string& uniformName, const glm::vec4& value)
+{
+	GLint location = GetUniformLocation(uniformName);
+	if (location < 0)
+	{
+		return;
+	}
+
+	auto last = m_activeCache->lastVec4Values.find(location);
+	if ((last != m_activeCache->lastVec4Values.end()) && (last->second == value))
+	{
+		return;
+	}
+
+	glUniform4fv(location, 1, glm::value_ptr(value));
+	FrameProfiler::Instance().CountStateChange();
+	m_activeCache->lastVec4Values[location] = value;
+}
+
+/***********************************************************
+ *  setMat4Value()
+ *
+ *  This method sends the passed in 4x4 matrix value into the
+ *  shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setMat4Value(const std::string& uniformName, const glm::mat4& value)
+{
+	GLint location = GetUniformLocation(uniformName);
+	if (location < 0)
+	{
+		return;
+	}
+
+	auto last = m_activeCache->lastMat4Values.find(location);
+	if ((last != m_activeCache->lastMat4Values.end()) && (last->second == value))
+	{
+		return;
+	}
+
+	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+	FrameProfiler::Instance().CountStateChange();
+	m_activeCache->lastMat4Values[location] = value;
+}
+
+/***********************************************************
+ *  setSampler2DValue()
+ *
+ *  This method sends the passed in texture slot index into
+ *  the shader program, skipping the call when unchanged.
+ ***********************************************************/
+void UniformCache::setSampler2DValue(const std::string& uniformName, int textureSlot)
+{
+	setIntValue(uniformName, textureSlot);
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcache.h
+// ============
+// caches the uniform locations and last-sent values per shader program so
+// the render loop does not resolve uniforms by string name or re-send
+// values a program already holds - with the specialized shader
+// permutations the active program changes mid-frame, so every program
+// keeps its own cache bucket
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+class UniformCache
+{
+public:
+	// access to the single shared cache instance
+	static UniformCache& Instance();
+
+	// drop every cached location and value and resolve against
+	// the currently active shader program - needed only when
+	// programs are relinked
+	void Reset();
+
+	// point the cache at the passed in shader program, creating
+	// its bucket on first use - the per-program values persist,
+	// so switching back to a program skips re-sends of whatever
+	// it already holds
+	void SetActiveProgram(GLuint programID);
+
+	// typed setters for the per-draw uniforms - each resolves
+	// the location once and skips the GL call when the value
+	// matches what was last sent to the program
+	void setIntValue(const std::string& uniformName, int value);
+	void setFloatValue(const std::string& uniformName, float value);
+	void setVec2Value(const std::string& uniformName, const glm::vec2& value);
+	void setVec3Value(const std::string& uniformName, const glm::vec3& value);
+	void setVec4Value(const std::string& uniformName, const glm::vec4& value);
+	void setMat4Value(const std::string& uniformName, const glm::mat4& value);
+	void setSampler2DValue(const std::string& uniformName, int textureSlot);
+
+private:
+	UniformCache() {}
+
+	// find the cached location for the named uniform in the
+	// active program's bucket, querying the driver only on the
+	// first request
+	GLint GetUniformLocation(const std::string& uniformName);
+
+	// everything cached for one shader program - the locations
+	// by name plus the last value sent per location
+	struct PROGRAM_CACHE
+	{
+		std::unordered_map<std::string, GLint> uniformLocations;
+		std::unordered_map<GLint, int> lastIntValues;
+		std::unordered_map<GLint, float> lastFloatValues;
+		std::unordered_map<GLint, glm::vec2> lastVec2Values;
+		std::unordered_map<GLint, glm::vec3> lastVec3Values;
+		std::unordered_map<GLint, glm::vec4> lastVec4Values;
+		std::unordered_map<GLint, glm::mat4> lastMat4Values;
+	};
+
+	// one bucket per shader program - each permutation holds its
+	// own uniform state, so a program switch never poisons the
+	// dirty checks of the others
+	std::unordered_map<GLuint, PROGRAM_CACHE> m_programCaches;
+	PROGRAM_CACHE* m_activeCache = nullptr;
+
+	// the program the active bucket belongs to
+	GLuint m_programID = 0;
+};
@@ -1,252 +1,765 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(ShaderManager* pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-
-	// Move camera further back (z=15) and slightly up (y=4) to see the desk
-	g_pCamera->Position = glm::vec3(0.0f, 4.0f, 15.0f);
-	// Look straight toward the back wall
-	g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 45.0f; // A narrower FOV prevents the warping you see
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-	//Callback for receiving mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	//Registering the scroll callback
-	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
-
-	// tell GLFW to capture all mouse events
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-//This will create the mnouse event to move around the camera, and this needs to be recorded
-//Subsequent mouse movement will be correctly calculated with the X position offset and Y position offset
-	if (gFirstMouse) {
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
-}
-//Calculating the X and Y offset values for moving in 3D
-float xOffset = xMousePos - gLastX;
-float yOffset = gLastY - yMousePos; //Reversing since the y-coordinates goes from bottom to top
-
-//Setting the current position into the last position variables
-gLastX = xMousePos;
-gLastY = yMousePos;
-
-//moving the camera in 3D according to the calculated offsets
-g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-}
-// Mouse_Scroll_Callback()
-void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset) {
-	g_pCamera->MovementSpeed += (float)yoffset * 0.5f;
-
-	if (g_pCamera->MovementSpeed < 0.1f)
-		g_pCamera->MovementSpeed = 0.1f;
-	if (g_pCamera->MovementSpeed > 20.0f)
-		g_pCamera->MovementSpeed = 20.0f;
-}
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-	// left camera
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	// Right camera
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
-	}
-	//Forward camera
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS) 
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	//Backwards Camera
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-	// Up on the camera
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	//Down on the camera
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
-	{
-		bOrthographicProjection = false;
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
-	{
-		bOrthographicProjection = true;
-	}
-}
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projection;
-
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	ProcessKeyboardEvents();
-
-	view = g_pCamera->GetViewMatrix();
-
-	// Calculate Aspect Ratio once
-	float aspectRatio = (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT;
-
-	// Handle Projection Toggle
-	if (bOrthographicProjection)
-	{
-		float orthoSize = 5.0f; // Smaller size makes objects look larger
-		projection = glm::ortho(-orthoSize * aspectRatio, orthoSize * aspectRatio, -orthoSize, orthoSize, 0.1f, 100.0f);
-	}
-	else
-	{
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, 0.1f, 100.0f);
-	}
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+#include "UniformBlocks.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	// Variables for window width and height
+	const int WINDOW_WIDTH = 1000;
+	const int WINDOW_HEIGHT = 800;
+
+	// camera object used for viewing and interacting with
+	// the 3D scene - owned by the fixed-rate update thread
+	// once it is running
+	Camera* g_pCamera = nullptr;
+
+	// these variables are used for mouse movement processing
+	float gLastX = WINDOW_WIDTH / 2.0f;
+	float gLastY = WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// the update thread steps the camera at this fixed rate, so
+	// movement stays smooth no matter how long a render frame
+	// takes
+	const int UPDATE_RATE_HZ = 120;
+	const float UPDATE_DELTA_TIME = 1.0f / (float)UPDATE_RATE_HZ;
+
+	// movement keys sampled into this bit mask on the render
+	// thread each frame and consumed by the update thread
+	const unsigned int KEY_BIT_LEFT = 1 << 0;
+	const unsigned int KEY_BIT_RIGHT = 1 << 1;
+	const unsigned int KEY_BIT_FORWARD = 1 << 2;
+	const unsigned int KEY_BIT_BACKWARD = 1 << 3;
+	const unsigned int KEY_BIT_UP = 1 << 4;
+	const unsigned int KEY_BIT_DOWN = 1 << 5;
+	std::atomic<unsigned int> gKeyStates(0);
+
+	// mouse and scroll deltas accumulated by the GLFW callbacks
+	// and drained by the update thread on its next tick
+	std::mutex gInputMutex;
+	float gPendingMouseX = 0.0f;
+	float gPendingMouseY = 0.0f;
+	float gPendingScroll = 0.0f;
+
+	// the camera state the update thread publishes for the
+	// render thread - double buffered so a publish never
+	// overwrites the snapshot a frame is being built from, with
+	// a short lock guarding only the copy and the index flip
+	struct CAMERA_SNAPSHOT
+	{
+		glm::vec3 position = glm::vec3(0.0f, 4.0f, 15.0f);
+		glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
+		glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+		float zoom = 45.0f;
+	};
+	CAMERA_SNAPSHOT gCameraSnapshots[2];
+	int gPublishedSnapshot = 0;
+	std::mutex gSnapshotMutex;
+
+	// the fixed-rate update thread and its running flag
+	std::thread gUpdateThread;
+	std::atomic<bool> gUpdateThreadRunning(false);
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on - only touched on the render
+	// thread, where the projection is built
+	bool bOrthographicProjection = false;
+
+	// the view state computed by the most recent call to
+	// PrepareSceneView(), exposed through the static accessors
+	glm::mat4 gViewMatrix = glm::mat4(1.0f);
+	glm::mat4 gProjectionMatrix = glm::mat4(1.0f);
+	glm::vec3 gViewPosition = glm::vec3(0.0f, 4.0f, 15.0f);
+
+	// everything one viewport needs - its window rectangle and
+	// the view it is rendered from
+	struct VIEWPORT_VIEW
+	{
+		int x = 0;
+		int y = 0;
+		int width = WINDOW_WIDTH;
+		int height = WINDOW_HEIGHT;
+		glm::mat4 view = glm::mat4(1.0f);
+		glm::mat4 projection = glm::mat4(1.0f);
+		glm::vec3 viewPosition = glm::vec3(0.0f, 4.0f, 15.0f);
+	};
+
+	// the per-viewport views computed by PrepareSceneView() -
+	// one full-window viewport normally, two halves when the
+	// split-screen mode is on
+	VIEWPORT_VIEW gViewportViews[ViewManager::MAX_VIEWPORTS];
+	int gViewportCount = 1;
+	bool gSplitScreen = false;
+
+	// the fixed overview camera of the split-screen mode -
+	// raised above the scene and looking down at its center
+	const glm::vec3 OVERVIEW_POSITION = glm::vec3(0.0f, 16.0f, 14.0f);
+	const glm::vec3 OVERVIEW_TARGET = glm::vec3(0.0f, 2.5f, 0.0f);
+
+	// the camera state the most recent rendered frame used -
+	// compared against the published snapshot so the render-on-
+	// change mode can tell whether the view moved since then
+	CAMERA_SNAPSHOT gRenderedSnapshot;
+	bool gRenderedOrtho = false;
+	bool gViewEverRendered = false;
+
+	// when true the camera follows the scripted benchmark
+	// orbit instead of the keyboard and mouse input
+	bool gBenchmarkMode = false;
+	int gBenchmarkFrameIndex = 0;
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager()
+{
+	m_pWindow = NULL;
+	g_pCamera = new Camera();
+
+	// Move camera further back (z=15) and slightly up (y=4) to see the desk
+	g_pCamera->Position = glm::vec3(0.0f, 4.0f, 15.0f);
+	// Look straight toward the back wall
+	g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = 45.0f; // A narrower FOV prevents the warping you see
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// make sure the update thread is no longer touching the
+	// camera before it is freed
+	StopUpdateThread();
+
+	// free up allocated memory
+	m_pWindow = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		WINDOW_WIDTH,
+		WINDOW_HEIGHT,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	//Callback for receiving mouse moving events
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+
+	//Registering the scroll callback
+	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
+
+	// tell GLFW to capture all mouse events
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// this callback is used to receive mouse moving events
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+
+	// set the blend function once - blending itself is only
+	// enabled around the transparent pass, so the opaque draws
+	// stay pure depth-tested fill
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+//This will create the mnouse event to move around the camera, and this needs to be recorded
+//Subsequent mouse movement will be correctly calculated with the X position offset and Y position offset
+	if (gFirstMouse) {
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+		gFirstMouse = false;
+}
+//Calculating the X and Y offset values for moving in 3D
+float xOffset = xMousePos - gLastX;
+float yOffset = gLastY - yMousePos; //Reversing since the y-coordinates goes from bottom to top
+
+//Setting the current position into the last position variables
+gLastX = xMousePos;
+gLastY = yMousePos;
+
+//queue the calculated offsets for the update thread - the
+//camera itself is only ever touched at the fixed update rate
+{
+	std::lock_guard<std::mutex> lock(gInputMutex);
+	gPendingMouseX += xOffset;
+	gPendingMouseY += yOffset;
+}
+}
+// Mouse_Scroll_Callback()
+void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset) {
+	// queue the scroll delta for the update thread, which
+	// applies it to the camera movement speed
+	std::lock_guard<std::mutex> lock(gInputMutex);
+	gPendingScroll += (float)yoffset;
+}
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method samples the keyboard state into the shared
+ *  bit mask for the update thread - GLFW input has to be
+ *  read on the main thread, but the camera movement itself
+ *  is applied at the fixed update rate.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents()
+{
+	// close the window if the escape key has been pressed
+	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+
+	// sample the camera movement keys
+	unsigned int keyStates = 0;
+	// left camera
+	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	{
+		keyStates |= KEY_BIT_LEFT;
+	}
+	// Right camera
+	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	{
+		keyStates |= KEY_BIT_RIGHT;
+	}
+	//Forward camera
+	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	{
+		keyStates |= KEY_BIT_FORWARD;
+	}
+	//Backwards Camera
+	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	{
+		keyStates |= KEY_BIT_BACKWARD;
+	}
+	// Up on the camera
+	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+	{
+		keyStates |= KEY_BIT_UP;
+	}
+	//Down on the camera
+	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	{
+		keyStates |= KEY_BIT_DOWN;
+	}
+	gKeyStates.store(keyStates);
+
+	// the projection toggle only affects the projection built
+	// on the render thread, so it is applied right here
+	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
+	{
+		bOrthographicProjection = false;
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
+	{
+		bOrthographicProjection = true;
+	}
+}
+
+/***********************************************************
+ *  StartUpdateThread()
+ *
+ *  This method starts the fixed-rate update thread that
+ *  owns the camera - input is sampled on the main thread
+ *  and applied here, so movement stays smooth even when a
+ *  render frame runs long.
+ ***********************************************************/
+void ViewManager::StartUpdateThread()
+{
+	if (gUpdateThreadRunning.load() == true)
+	{
+		return;
+	}
+
+	// publish the camera's starting state so the render thread
+	// has a valid view before the first update tick
+	CAMERA_SNAPSHOT snapshot;
+	snapshot.position = g_pCamera->Position;
+	snapshot.front = g_pCamera->Front;
+	snapshot.up = g_pCamera->Up;
+	snapshot.zoom = g_pCamera->Zoom;
+	gCameraSnapshots[0] = snapshot;
+	gCameraSnapshots[1] = snapshot;
+	gPublishedSnapshot = 0;
+
+	gUpdateThreadRunning.store(true);
+	gUpdateThread = std::thread([this]()
+	{
+		UpdateThreadMain();
+	});
+
+	std::cout << "INFO: Camera update thread running at "
+		<< UPDATE_RATE_HZ << "Hz" << std::endl;
+}
+
+/***********************************************************
+ *  StopUpdateThread()
+ *
+ *  This method stops the fixed-rate update thread and waits
+ *  for it to finish its current tick.
+ ***********************************************************/
+void ViewManager::StopUpdateThread()
+{
+	if (gUpdateThreadRunning.load() == false)
+	{
+		return;
+	}
+
+	gUpdateThreadRunning.store(false);
+	if (gUpdateThread.joinable() == true)
+	{
+		gUpdateThread.join();
+	}
+}
+
+/***********************************************************
+ *  UpdateThreadMain()
+ *
+ *  This method is the body of the fixed-rate update thread -
+ *  each tick drains the queued mouse and scroll deltas,
+ *  applies the sampled movement keys with the fixed timestep,
+ *  and publishes the camera state for the render thread.
+ ***********************************************************/
+void ViewManager::UpdateThreadMain()
+{
+	std::chrono::steady_clock::time_point nextTick =
+		std::chrono::steady_clock::now();
+
+	while (gUpdateThreadRunning.load() == true)
+	{
+		// drain the input the callbacks queued since the last tick
+		float mouseX = 0.0f;
+		float mouseY = 0.0f;
+		float scroll = 0.0f;
+		{
+			std::lock_guard<std::mutex> lock(gInputMutex);
+			mouseX = gPendingMouseX;
+			mouseY = gPendingMouseY;
+			scroll = gPendingScroll;
+			gPendingMouseX = 0.0f;
+			gPendingMouseY = 0.0f;
+			gPendingScroll = 0.0f;
+		}
+
+		// scrolling adjusts how fast the camera moves
+		if (scroll != 0.0f)
+		{
+			g_pCamera->MovementSpeed += scroll * 0.5f;
+			if (g_pCamera->MovementSpeed < 0.1f)
+				g_pCamera->MovementSpeed = 0.1f;
+			if (g_pCamera->MovementSpeed > 20.0f)
+				g_pCamera->MovementSpeed = 20.0f;
+		}
+
+		// moving the camera in 3D according to the queued offsets
+		if ((mouseX != 0.0f) || (mouseY != 0.0f))
+		{
+			g_pCamera->ProcessMouseMovement(mouseX, mouseY);
+		}
+
+		// apply the sampled movement keys with the fixed timestep
+		unsigned int keyStates = gKeyStates.load();
+		if ((keyStates & KEY_BIT_LEFT) != 0)
+		{
+			g_pCamera->ProcessKeyboard(LEFT, UPDATE_DELTA_TIME);
+		}
+		if ((keyStates & KEY_BIT_RIGHT) != 0)
+		{
+			g_pCamera->ProcessKeyboard(RIGHT, UPDATE_DELTA_TIME);
+		}
+		if ((keyStates & KEY_BIT_FORWARD) != 0)
+		{
+			g_pCamera->ProcessKeyboard(FORWARD, UPDATE_DELTA_TIME);
+		}
+		if ((keyStates & KEY_BIT_BACKWARD) != 0)
+		{
+			g_pCamera->ProcessKeyboard(BACKWARD, UPDATE_DELTA_TIME);
+		}
+		if ((keyStates & KEY_BIT_UP) != 0)
+		{
+			g_pCamera->ProcessKeyboard(UP, UPDATE_DELTA_TIME);
+		}
+		if ((keyStates & KEY_BIT_DOWN) != 0)
+		{
+			g_pCamera->ProcessKeyboard(DOWN, UPDATE_DELTA_TIME);
+		}
+
+		// publish the new camera state into the back buffer and
+		// flip - the lock covers only this copy
+		CAMERA_SNAPSHOT snapshot;
+		snapshot.position = g_pCamera->Position;
+		snapshot.front = g_pCamera->Front;
+		snapshot.up = g_pCamera->Up;
+		snapshot.zoom = g_pCamera->Zoom;
+		{
+			std::lock_guard<std::mutex> lock(gSnapshotMutex);
+			gCameraSnapshots[1 - gPublishedSnapshot] = snapshot;
+			gPublishedSnapshot = 1 - gPublishedSnapshot;
+		}
+
+		// hold the fixed rate
+		nextTick += std::chrono::microseconds(1000000 / UPDATE_RATE_HZ);
+		std::this_thread::sleep_until(nextTick);
+	}
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void ViewManager::PrepareSceneView()
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	float cameraZoom = 45.0f;
+
+	if (gBenchmarkMode == true)
+	{
+		// scripted orbit around the scene center, driven by the
+		// frame index so the path is identical on every run
+		float angle = glm::radians((float)gBenchmarkFrameIndex * 0.5f);
+		float orbitRadius = 15.0f;
+		glm::vec3 sceneCenter = glm::vec3(0.0f, 2.5f, 0.0f);
+
+		g_pCamera->Position = sceneCenter + glm::vec3(
+			sin(angle) * orbitRadius,
+			1.5f + sin(angle * 0.35f),
+			cos(angle) * orbitRadius);
+		g_pCamera->Front = glm::normalize(sceneCenter - g_pCamera->Position);
+		gBenchmarkFrameIndex++;
+
+		view = glm::lookAt(
+			g_pCamera->Position,
+			sceneCenter,
+			glm::vec3(0.0f, 1.0f, 0.0f));
+		viewPosition = g_pCamera->Position;
+		cameraZoom = g_pCamera->Zoom;
+	}
+	else
+	{
+		// sample the keyboard for the update thread, which owns
+		// the camera and steps it at its own fixed rate
+		ProcessKeyboardEvents();
+
+		// build the view from the snapshot the update thread
+		// last published
+		CAMERA_SNAPSHOT snapshot;
+		{
+			std::lock_guard<std::mutex> lock(gSnapshotMutex);
+			snapshot = gCameraSnapshots[gPublishedSnapshot];
+		}
+
+		view = glm::lookAt(
+			snapshot.position,
+			snapshot.position + snapshot.front,
+			snapshot.up);
+		viewPosition = snapshot.position;
+		cameraZoom = snapshot.zoom;
+
+		// remember what this frame was rendered with, so the
+		// render-on-change mode can tell when the view moves
+		gRenderedSnapshot = snapshot;
+		gRenderedOrtho = bOrthographicProjection;
+		gViewEverRendered = true;
+	}
+
+	// split-screen halves the operator viewport - the benchmark
+	// always renders the single full-window view so its numbers
+	// stay comparable across runs
+	bool bSplitThisFrame = ((gSplitScreen == true) && (gBenchmarkMode == false));
+	int viewportWidth = (bSplitThisFrame == true) ? (WINDOW_WIDTH / 2) : WINDOW_WIDTH;
+
+	// Calculate Aspect Ratio once
+	float aspectRatio = (float)viewportWidth / (float)WINDOW_HEIGHT;
+
+	// Handle Projection Toggle
+	if (bOrthographicProjection)
+	{
+		float orthoSize = 5.0f; // Smaller size makes objects look larger
+		projection = glm::ortho(-orthoSize * aspectRatio, orthoSize * aspectRatio, -orthoSize, orthoSize, 0.1f, 100.0f);
+	}
+	else
+	{
+		projection = glm::perspective(glm::radians(cameraZoom), aspectRatio, 0.1f, 100.0f);
+	}
+
+	// keep the computed view state available for render paths
+	// that manage their own shader programs
+	gViewMatrix = view;
+	gProjectionMatrix = projection;
+	gViewPosition = viewPosition;
+
+	// viewport 0 is always the operator view
+	gViewportViews[0].x = 0;
+	gViewportViews[0].y = 0;
+	gViewportViews[0].width = viewportWidth;
+	gViewportViews[0].height = WINDOW_HEIGHT;
+	gViewportViews[0].view = view;
+	gViewportViews[0].projection = projection;
+	gViewportViews[0].viewPosition = viewPosition;
+	gViewportCount = 1;
+
+	// the right half shows the fixed overview camera - only its
+	// rectangle beside the operator view ever changes
+	if (bSplitThisFrame == true)
+	{
+		gViewportViews[1].x = viewportWidth;
+		gViewportViews[1].y = 0;
+		gViewportViews[1].width = WINDOW_WIDTH - viewportWidth;
+		gViewportViews[1].height = WINDOW_HEIGHT;
+		gViewportViews[1].view = glm::lookAt(
+			OVERVIEW_POSITION, OVERVIEW_TARGET, glm::vec3(0.0f, 1.0f, 0.0f));
+		gViewportViews[1].projection = glm::perspective(
+			glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
+		gViewportViews[1].viewPosition = OVERVIEW_POSITION;
+		gViewportCount = 2;
+	}
+
+	// upload the camera state through the shared uniform block
+	// - one transfer for the whole frame, skipped when the
+	// camera has not moved; the render paths rebind the block
+	// per viewport through ApplyViewport()
+	UniformBlocks::CAMERA_BLOCK cameraBlock;
+	cameraBlock.view = view;
+	cameraBlock.projection = projection;
+	cameraBlock.viewPosition = glm::vec4(viewPosition, 1.0f);
+	UniformBlocks::Instance().SetCameraBlock(cameraBlock);
+}
+
+/***********************************************************
+ *  GetViewMatrix()
+ *
+ *  This method returns the view matrix computed by the most
+ *  recent call to PrepareSceneView().
+ ***********************************************************/
+glm::mat4 ViewManager::GetViewMatrix()
+{
+	return(gViewMatrix);
+}
+
+/***********************************************************
+ *  GetProjectionMatrix()
+ *
+ *  This method returns the projection matrix computed by the
+ *  most recent call to PrepareSceneView().
+ ***********************************************************/
+glm::mat4 ViewManager::GetProjectionMatrix()
+{
+	return(gProjectionMatrix);
+}
+
+/***********************************************************
+ *  EnableBenchmarkMode()
+ *
+ *  This method switches the camera onto the scripted
+ *  benchmark orbit for the rest of the session.
+ ***********************************************************/
+void ViewManager::EnableBenchmarkMode()
+{
+	gBenchmarkMode = true;
+	gBenchmarkFrameIndex = 0;
+}
+
+/***********************************************************
+ *  GetViewPosition()
+ *
+ *  This method returns the camera position used by the most
+ *  recent call to PrepareSceneView().
+ ***********************************************************/
+glm::vec3 ViewManager::GetViewPosition()
+{
+	return(gViewPosition);
+}
+
+/***********************************************************
+ *  GetViewMatrix(int)
+ *
+ *  This method returns the view matrix of the passed in
+ *  viewport.
+ ***********************************************************/
+glm::mat4 ViewManager::GetViewMatrix(int viewportIndex)
+{
+	return(gViewportViews[viewportIndex].view);
+}
+
+/***********************************************************
+ *  GetProjectionMatrix(int)
+ *
+ *  This method returns the projection matrix of the passed
+ *  in viewport.
+ ***********************************************************/
+glm::mat4 ViewManager::GetProjectionMatrix(int viewportIndex)
+{
+	return(gViewportViews[viewportIndex].projection);
+}
+
+/***********************************************************
+ *  GetViewPosition(int)
+ *
+ *  This method returns the camera position of the passed in
+ *  viewport.
+ ***********************************************************/
+glm::vec3 ViewManager::GetViewPosition(int viewportIndex)
+{
+	return(gViewportViews[viewportIndex].viewPosition);
+}
+
+/***********************************************************
+ *  EnableSplitScreen()
+ *
+ *  This method switches the window into split-screen mode
+ *  for the rest of the session - the left half shows the
+ *  interactive operator camera and the right half a fixed
+ *  overview of the whole scene.
+ ***********************************************************/
+void ViewManager::EnableSplitScreen()
+{
+	gSplitScreen = true;
+	std::cout << "INFO: Split-screen mode - operator view left, "
+		<< "overview right" << std::endl;
+}
+
+/***********************************************************
+ *  GetViewportCount()
+ *
+ *  This method returns the number of viewports the most
+ *  recent PrepareSceneView() call computed views for.
+ ***********************************************************/
+int ViewManager::GetViewportCount()
+{
+	return(gViewportCount);
+}
+
+/***********************************************************
+ *  ApplyViewport()
+ *
+ *  This method points the GL viewport rectangle and the
+ *  shared camera uniform block at one viewport's view - the
+ *  draws recorded for the frame can then just be submitted
+ *  again for this viewport.
+ ***********************************************************/
+void ViewManager::ApplyViewport(int viewportIndex)
+{
+	if ((viewportIndex < 0) || (viewportIndex >= gViewportCount))
+	{
+		return;
+	}
+
+	const VIEWPORT_VIEW& viewportView = gViewportViews[viewportIndex];
+
+	glViewport(
+		viewportView.x, viewportView.y,
+		viewportView.width, viewportView.height);
+
+	UniformBlocks::CAMERA_BLOCK cameraBlock;
+	cameraBlock.view = viewportView.view;
+	cameraBlock.projection = viewportView.projection;
+	cameraBlock.viewPosition = glm::vec4(viewportView.viewPosition, 1.0f);
+	UniformBlocks::Instance().SetCameraBlock(cameraBlock);
+}
+
+/***********************************************************
+ *  SampleInputEvents()
+ *
+ *  This method samples the keyboard on the main thread for
+ *  frames the render-on-change mode skips - a held movement
+ *  key still reaches the update thread and wakes the view.
+ ***********************************************************/
+void ViewManager::SampleInputEvents()
+{
+	ProcessKeyboardEvents();
+}
+
+/***********************************************************
+ *  IsViewDirty()
+ *
+ *  This method returns true when the view has changed since
+ *  the last rendered frame - the update thread's published
+ *  camera snapshot or the projection toggle differs from
+ *  what that frame was built with.
+ ***********************************************************/
+bool ViewManager::IsViewDirty()
+{
+	// the scripted benchmark moves every frame, and nothing
+	// has been rendered yet on the very first one
+	if ((gBenchmarkMode == true) || (gViewEverRendered == false))
+	{
+		return(true);
+	}
+
+	CAMERA_SNAPSHOT snapshot;
+	{
+		std::lock_guard<std::mutex> lock(gSnapshotMutex);
+		snapshot = gCameraSnapshots[gPublishedSnapshot];
+	}
+
+	if ((snapshot.position != gRenderedSnapshot.position) ||
+		(snapshot.front != gRenderedSnapshot.front) ||
+		(snapshot.up != gRenderedSnapshot.up) ||
+		(snapshot.zoom != gRenderedSnapshot.zoom) ||
+		(bOrthographicProjection != gRenderedOrtho))
+	{
+		return(true);
+	}
+
+	return(false);
 }
\ No newline at end of file
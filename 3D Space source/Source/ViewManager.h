@@ -9,9 +9,10 @@
 
 #pragma once
 
-#include "ShaderManager.h"
 #include "camera.h"
 
+#include <glm/glm.hpp>
+
 // GLFW library
 #include "GLFW/glfw3.h" 
 
@@ -19,8 +20,7 @@ class ViewManager
 {
 public:
 	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
+	ViewManager();
 	// destructor
 	~ViewManager();
 
@@ -28,20 +28,72 @@ public:
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
 
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
 
-	// process keyboard events for interaction with the 3D scene
+	// sample the keyboard state for the update thread
 	void ProcessKeyboardEvents();
 
+	// body of the fixed-rate update thread
+	void UpdateThreadMain();
+
 public:
 	// create the initial OpenGL display window
 	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// access to the view state computed by the most recent
+	// PrepareSceneView() call, for render paths that manage
+	// their own shader programs - the indexed overloads read
+	// a specific viewport's state, the plain ones viewport 0
+	static glm::mat4 GetViewMatrix();
+	static glm::mat4 GetProjectionMatrix();
+	static glm::vec3 GetViewPosition();
+	static glm::mat4 GetViewMatrix(int viewportIndex);
+	static glm::mat4 GetProjectionMatrix(int viewportIndex);
+	static glm::vec3 GetViewPosition(int viewportIndex);
+
+	// the most viewports a frame can render - the scene is
+	// traversed and recorded once, then re-submitted per
+	// viewport with only the camera state rebound
+	static const int MAX_VIEWPORTS = 2;
+
+	// switch the window into split-screen mode - the left half
+	// shows the interactive operator camera and the right half
+	// a fixed overview of the whole scene
+	static void EnableSplitScreen();
+
+	// number of viewports PrepareSceneView() computed views for
+	static int GetViewportCount();
+
+	// point the GL viewport rectangle and the shared camera
+	// uniform block at one viewport's view - everything already
+	// recorded for the frame can then just be drawn again
+	static void ApplyViewport(int viewportIndex);
+
+	// sample the keyboard for frames the render-on-change mode
+	// skips, so held keys still wake the camera
+	void SampleInputEvents();
+
+	// true when the published camera state or the projection
+	// toggle differs from what the last rendered frame used -
+	// the render-on-change mode redraws only when this or the
+	// scene reports a change
+	static bool IsViewDirty();
+
+	// start/stop the fixed-rate update thread that owns the
+	// camera - input is sampled on the main thread each frame
+	// and applied on this thread at a steady rate, so movement
+	// stays smooth even when a render frame runs long
+	void StartUpdateThread();
+	void StopUpdateThread();
+
+	// switch the camera onto the scripted benchmark path -
+	// the view then depends only on the frame index, so every
+	// benchmark run renders the exact same frames
+	static void EnableBenchmarkMode();
 public:
 	static void Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+// fragmentShader.glsl
+// ============
+// fragment stage for the 3D scene - one directional light plus one
+// spotlight, with the lighting rig arriving through the shared
+// LightingBlock uniform buffer instead of per-frame uniform calls;
+// compiled into specialized permutations by ShaderVariants, which
+// injects the USE_TEXTURE and USE_LIGHTING defines below
+
+#version 430 core
+
+// the permutation defines are injected directly after the #version
+// line above - default to the fully featured permutation so the file
+// still compiles standalone
+#ifndef USE_TEXTURE
+#define USE_TEXTURE 1
+#endif
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 1
+#endif
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+out vec4 outFragmentColor;
+
+// per-frame camera state shared by every shader program
+layout (std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+// the scene lighting rig, uploaded once and only re-sent when
+// a light actually changes
+layout (std140, binding = 1) uniform LightingBlock
+{
+	vec4 dirLightDirection;
+	vec4 dirLightAmbient;
+	vec4 dirLightDiffuse;
+	vec4 spotLightPosition;
+	vec4 spotLightDirection;
+	vec4 spotLightAmbient;
+	vec4 spotLightDiffuse;
+	vec4 spotLightSpecular;
+	// constant, linear, quadratic attenuation
+	vec4 spotLightAttenuation;
+	// cutOff and outerCutOff cosines
+	vec4 spotLightCone;
+};
+
+struct Material
+{
+	vec3 ambientColor;
+	float ambientStrength;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float shininess;
+};
+
+uniform vec4 objectColor = vec4(1.0);
+// every scene texture lives in one array bound to unit 0 -
+// objects select theirs by layer index, never by sampler rebind
+layout (binding = 0) uniform sampler2DArray objectTextureArray;
+uniform int textureLayer = 0;
+uniform Material material;
+
+void main()
+{
+#if USE_TEXTURE
+	vec4 baseColor = texture(objectTextureArray,
+		vec3(fragmentTextureCoordinate, float(textureLayer)));
+#else
+	vec4 baseColor = objectColor;
+#endif
+
+#if !USE_LIGHTING
+	outFragmentColor = baseColor;
+#else
+	vec3 normal = normalize(fragmentVertexNormal);
+	vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+
+	// directional light contribution
+	vec3 lightDirection = normalize(-dirLightDirection.xyz);
+	float diffuseFactor = max(dot(normal, lightDirection), 0.0);
+	vec3 result = dirLightAmbient.rgb * material.ambientStrength * material.ambientColor;
+	result += dirLightDiffuse.rgb * diffuseFactor * material.diffuseColor;
+
+	// spotlight contribution with smooth cone edges
+	vec3 spotDirection = normalize(spotLightPosition.xyz - fragmentPosition);
+	float theta = dot(spotDirection, normalize(-spotLightDirection.xyz));
+	float epsilon = spotLightCone.x - spotLightCone.y;
+	float intensity = clamp((theta - spotLightCone.y) / epsilon, 0.0, 1.0);
+
+	float distance = length(spotLightPosition.xyz - fragmentPosition);
+	float attenuation = 1.0 / (spotLightAttenuation.x + spotLightAttenuation.y * distance +
+		spotLightAttenuation.z * (distance * distance));
+
+	float spotDiffuseFactor = max(dot(normal, spotDirection), 0.0);
+	vec3 reflectDirection = reflect(-spotDirection, normal);
+	float specularFactor = pow(max(dot(viewDirection, reflectDirection), 0.0), material.shininess);
+
+	result += spotLightAmbient.rgb * material.ambientStrength * material.ambientColor;
+	result += spotLightDiffuse.rgb * spotDiffuseFactor * material.diffuseColor * intensity * attenuation;
+	result += spotLightSpecular.rgb * specularFactor * material.specularColor * intensity * attenuation;
+
+	outFragmentColor = vec4(result, 1.0) * baseColor;
+#endif
+}
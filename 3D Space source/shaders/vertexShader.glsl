@@ -0,0 +1,35 @@
+// vertexShader.glsl
+// ============
+// vertex stage for the 3D scene - the per-frame camera state arrives
+// through the shared CameraBlock uniform buffer, only the per-object
+// model matrix and UV scale remain plain uniforms
+
+#version 430 core
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// per-frame camera state shared by every shader program
+layout (std140, binding = 0) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	vec4 viewPosition;
+};
+
+uniform mat4 model;
+uniform vec2 UVscale = vec2(1.0, 1.0);
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+void main()
+{
+	fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
+	fragmentVertexNormal = mat3(transpose(inverse(model))) * inVertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate * UVscale;
+
+	gl_Position = projection * view * vec4(fragmentPosition, 1.0);
+}